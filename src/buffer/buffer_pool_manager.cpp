@@ -4,146 +4,228 @@
 #include "page/bitmap_page.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <unordered_map>
 
-static const char EMPTY_PAGE_DATA[PAGE_SIZE] = {0};
+static const char EMPTY_PAGE_DATA[MAX_PAGE_SIZE] = {0};
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager) {
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
-  for (size_t i = 0; i < pool_size_; i++) {
-    free_list_.emplace_back(i);
+namespace {
+/**
+ * A pin or unpin that happened without the latch and has not been told to the replacer yet
+ */
+struct FrameAccess {
+  frame_id_t frame_id;
+  page_id_t page_id;
+  bool unpin;
+};
+
+struct AccessBatch {
+  size_t size{0};
+  FrameAccess accesses[ACCESS_BATCH_SIZE];
+};
+
+atomic<uint64_t> next_instance_id{0};
+thread_local unordered_map<uint64_t, AccessBatch> access_batches;  // keyed by buffer pool instance id
+}  // namespace
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, ReplacerType replacer_type,
+                                     size_t max_pool_size)
+    : disk_manager_(disk_manager),
+      pool_size_(pool_size),
+      arena_(max(pool_size, max_pool_size), disk_manager->GetPageSize()),
+      page_table_(pool_size),
+      instance_id_(next_instance_id++) {
+  ASSERT(arena_.MaxFrames() <= static_cast<size_t>(MAX_BUFFER_POOL_SIZE), "Buffer pool too large.");
+  // the descriptors are allocated in one array apart from the arena, and constructed as the pool grows
+  pages_ = static_cast<Page *>(::operator new[](arena_.MaxFrames() * sizeof(Page)));
+  switch (replacer_type) {
+    case ReplacerType::CLOCK_REPLACER:
+      replacer_ = new ClockReplacer(pool_size_);
+      break;
+    case ReplacerType::LRU_K_REPLACER:
+      replacer_ = new LRUKReplacer(pool_size_);
+      break;
+    default:
+      replacer_ = new LRUReplacer(pool_size_);
+      break;
   }
+  AddFrames(pool_size_);
+  ResetRing();
+  flusher_ = thread(&BufferPoolManager::FlusherLoop, this);
 }
 
+BufferPoolManager::BufferPoolManager(DiskManager *disk_manager)
+    : disk_manager_(disk_manager),
+      pool_size_(0),
+      pages_(nullptr),
+      arena_(0),
+      page_table_(0),
+      replacer_(nullptr),
+      instance_id_(next_instance_id++) {}
+
 BufferPoolManager::~BufferPoolManager() {
-  for (auto page : page_table_) {
-    FlushPage(page.first);
+  StopPrefetchThreads();
+  if (num_frames_ > 0) {
+    SaveResidentPages();
+  }
+  if (flusher_.joinable()) {
+    {
+      scoped_lock<mutex> lock(flusher_latch_);
+      stop_flusher_ = true;
+    }
+    flusher_cv_.notify_one();
+    flusher_.join();
+  }
+  if (num_frames_ > 0) {
+    FlushAllPages();
+  }
+  access_batches.erase(instance_id_);
+  for (size_t i = 0; i < num_frames_; i++) {
+    pages_[i].~Page();
   }
-  delete[] pages_;
+  ::operator delete[](pages_);
   delete replacer_;
 }
 
 /**
  * TODO: Student Implement
  */
-Page *BufferPoolManager::FetchPage(page_id_t page_id, bool flag) {
-
+Page *BufferPoolManager::FetchPage(page_id_t page_id, bool bulk_read) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
   //        Note that pages are always found from the free list first.
+  //        Bulk reads recycle the frames of their own ring instead, so they do not flush the whole pool.
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  
-  // find the page
-  // if successfully find it, pin it.
-  if (page_table_.count(page_id) > 0) {
-    frame_id_t frame_id = page_table_[page_id];
-    replacer_->Pin(frame_id);
-    pages_[frame_id].pin_count_++;
-    // return the page
-    return &(pages_[frame_id]);
-  }
 
-  // if the page is not in the page table
-  // check if the free_list is not empty
-  if (free_list_.size() > 0) {
-    // update the members
-    frame_id_t frame_id = free_list_.front();
-    free_list_.pop_front();
-    disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
-    replacer_->Pin(frame_id);
-    pages_[frame_id].pin_count_ = 1;
-    pages_[frame_id].page_id_ = page_id;
-    pages_[frame_id].is_dirty_ = false; // the new page is clean
-    page_table_.insert(make_pair(page_id, frame_id));
+  // find the page without the latch, if successfully find it, pin it.
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id) && TryPinFrame(frame_id, page_id)) {
+    RecordAccess(frame_id, page_id, false);
     return &(pages_[frame_id]);
   }
-  // check if the replacer has pages to be replaced
-  else if (replacer_->Size() > 0){
-    frame_id_t frame_id;
-    if (replacer_->Victim(&frame_id)) {
-      Page* replacePage = &(pages_[frame_id]);
-      
-      // if the page to be replaced is dirty, write it back to the disk
-      if (replacePage->IsDirty()) {
-        disk_manager_->WritePage(replacePage->page_id_, replacePage->data_);
-        replacePage->is_dirty_ = false; // the new page is clean
-      }
 
-      // remove the replacePage from the page table
-      page_table_.erase(page_table_.find(replacePage->page_id_));
-      
-      // read the new page in the disk and update the members
-      disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
+  unique_lock<recursive_mutex> lock(latch_);
+  ApplyAccesses();
+  // the page may have been read in by another thread, or moved in the page table while we looked it up
+  while (page_table_.Find(page_id, &frame_id)) {
+    // frames in the page table are only locked while the latch is held or a prefetch reads their page in
+    if (pages_[frame_id].pin_count_ >= 0) {
+      pages_[frame_id].pin_count_++;
       replacer_->Pin(frame_id);
-      pages_[frame_id].pin_count_ = 1;
-      pages_[frame_id].page_id_ = page_id;
-      page_table_.insert(make_pair(page_id, frame_id));
       return &(pages_[frame_id]);
     }
+    lock.unlock();
+    this_thread::yield();
+    lock.lock();
   }
+
+  // if the page is not in the page table, read it into a free frame
+  frame_id = ReadInPage(page_id, bulk_read);
   // if no page is able to be replaced
-  return nullptr;
+  if (frame_id == INVALID_FRAME_ID) return nullptr;
+  replacer_->Pin(frame_id);
+  pages_[frame_id].pin_count_ = 1;  // publish the frame to lock-free fetches
+  return &(pages_[frame_id]);
+}
+
+frame_id_t BufferPoolManager::ReadInPage(page_id_t page_id, bool bulk_read) {
+  frame_id_t frame_id = bulk_read ? TryToFindRingPage(page_id) : TryToFindFreePage();
+  if (frame_id == INVALID_FRAME_ID) return INVALID_FRAME_ID;
+  // read the page in the disk and update the members
+  disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
+  pages_[frame_id].page_id_ = page_id;
+  MarkClean(frame_id); // the new page is clean
+  page_table_.Insert(page_id, frame_id);
+  return frame_id;
 }
 
 /**
  * TODO: Student Implement
  */
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  ApplyAccesses();
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  if (!free_list_.empty()) { // if the free list still has place
-    page_id = AllocatePage();
-    if (page_id != INVALID_PAGE_ID) {
-      frame_id_t frame_id = free_list_.front();
-      free_list_.pop_front();
-      replacer_->Pin(frame_id); // still have problem here
-      pages_[frame_id].pin_count_ = 1;
-      pages_[frame_id].page_id_ = page_id;
-      pages_[frame_id].is_dirty_ = false;
-      pages_[frame_id].ResetMemory(); // the new page is unused
-      page_table_.insert(make_pair(page_id, frame_id));
-      return &(pages_[frame_id]);
-    }
+  page_id = INVALID_PAGE_ID;
+  frame_id_t frame_id = TryToFindFreePage();
+  if (frame_id == INVALID_FRAME_ID) return nullptr;
+  page_id = AllocatePage();
+  if (page_id == INVALID_PAGE_ID) { // if there are no more free pages to be allocated, give the frame back
+    free_list_.push_back(frame_id);
+    return nullptr;
   }
-  else if (replacer_->Size() > 0){ // if the lru still has pages to be replaced
-    frame_id_t frame_id;
-    if (replacer_->Victim(&frame_id)) {
-      Page* replacePage = &(pages_[frame_id]);
-      // if the page to be replaced is dirty, write it back to the disk
-      if (replacePage->IsDirty()) {
-        disk_manager_->WritePage(replacePage->page_id_, replacePage->data_);
-        replacePage->is_dirty_ = false; // the new page is clean
-      }
-      // remove the replacePage from the page table
-      page_table_.erase(page_table_.find(replacePage->page_id_));
-      // allocate the new page
-      page_id = AllocatePage();
-      if (page_id != INVALID_PAGE_ID) { // if there are free pages in the disk
-        pages_[frame_id].ResetMemory();
-        // replacer_->Pin(frame_id);
-        pages_[frame_id].pin_count_ = 1;
-        pages_[frame_id].page_id_ = page_id;
-        page_table_.insert(make_pair(page_id, frame_id));
-        return &(pages_[frame_id]);
+  return InitNewPage(frame_id, page_id);
+}
+
+Page *BufferPoolManager::NewPage(page_id_t &page_id, PageReservation *reservation) {
+  scoped_lock<mutex> lock(reservation->latch_);
+  if (reservation->next_page_id_ == reservation->end_page_id_) {
+    page_id_t first_page_id = disk_manager_->AllocatePages(SEGMENT_RUN_PAGES, reservation->space_id_);
+    if (first_page_id == INVALID_PAGE_ID) {
+      page_id = disk_manager_->AllocatePage(reservation->space_id_);
+      if (page_id == INVALID_PAGE_ID) return nullptr;
+      Page *page = GetInstance(page_id)->NewPageWithId(page_id);
+      if (page == nullptr) {  // every frame is pinned, give the page back
+        disk_manager_->DeAllocatePage(page_id);
+        page_id = INVALID_PAGE_ID;
       }
+      return page;
     }
+    reservation->next_page_id_ = first_page_id;
+    reservation->end_page_id_ = first_page_id + SEGMENT_RUN_PAGES;
   }
-  // if there are no more free pages to be allocated
-  page_id = INVALID_PAGE_ID;
-  return nullptr;
+  page_id = reservation->next_page_id_;
+  Page *page = GetInstance(page_id)->NewPageWithId(page_id);
+  if (page == nullptr) {  // every frame is pinned, the page stays reserved for the next call
+    page_id = INVALID_PAGE_ID;
+    return nullptr;
+  }
+  reservation->next_page_id_++;
+  return page;
+}
+
+void BufferPoolManager::ReleasePages(PageReservation *reservation) {
+  scoped_lock<mutex> lock(reservation->latch_);
+  if (reservation->next_page_id_ != reservation->end_page_id_) {
+    disk_manager_->DeAllocatePages(reservation->next_page_id_,
+                                   reservation->end_page_id_ - reservation->next_page_id_);
+  }
+  reservation->next_page_id_ = reservation->end_page_id_ = INVALID_PAGE_ID;
+}
+
+Page *BufferPoolManager::NewPageWithId(page_id_t page_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  ApplyAccesses();
+  frame_id_t frame_id = TryToFindFreePage();
+  if (frame_id == INVALID_FRAME_ID) return nullptr;
+  return InitNewPage(frame_id, page_id);
+}
+
+Page *BufferPoolManager::InitNewPage(frame_id_t frame_id, page_id_t page_id) {
+  replacer_->Pin(frame_id);
+  pages_[frame_id].page_id_ = page_id;
+  MarkClean(frame_id);
+  pages_[frame_id].ResetMemory(); // the new page is unused
+  page_table_.Insert(page_id, frame_id);
+  pages_[frame_id].pin_count_ = 1;
+  return &(pages_[frame_id]);
 }
 
 /**
  * TODO: Student Implement
  */
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  ApplyAccesses();
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
   // 1.   If P does not exist, return true.
@@ -151,62 +233,520 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
 
   // find the page
-  // auto it = std::find(page_table_.begin(), page_table_.end(), page_id); 
   frame_id_t frame_id;
-  if (page_table_.count(page_id) <= 0) { // if P does not exist, return true
+  if (!page_table_.Find(page_id, &frame_id)) { // if P does not exist, return true
     DeallocatePage(page_id);
     return true;
   }
   else { // if P exist
-    frame_id = page_table_[page_id];
-    Page* delPage = &(pages_[frame_id]);
-    if (delPage->pin_count_ > 0) return false; // if the pin count is not 0
-    
-    // if the page can be deleted
-    page_table_.erase(page_table_.find(page_id));
-    
-    delPage->ResetMemory();
-    delPage->pin_count_ = 0;
-    delPage->page_id_ = INVALID_PAGE_ID;
-    delPage->is_dirty_ = false;
-    
-    // add it to the free_list
-    free_list_.push_back(frame_id);
+    if (!LockFrame(frame_id)) return false; // if the pin count is not 0
+
+    // if the page can be deleted, the frame stays locked on the free list
+    DropFrame(frame_id);
     DeallocatePage(page_id);
     return true;
   }
 }
 
+void BufferPoolManager::DropFrame(frame_id_t frame_id) {
+  Page *page = &(pages_[frame_id]);
+  page_table_.Erase(page->page_id_);
+  replacer_->Remove(frame_id);
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  MarkClean(frame_id);
+  // add it to the free_list, unless the pool has shrunk below it
+  if (static_cast<size_t>(frame_id) >= pool_size_) {
+    RetireFrame(frame_id);
+  } else {
+    free_list_.push_back(frame_id);
+  }
+}
+
+void BufferPoolManager::DiscardPages(page_id_t first_page_id, page_id_t last_page_id) {
+  for (bool busy = true; busy;) {
+    busy = false;
+    {
+      scoped_lock<recursive_mutex> lock(latch_);
+      ApplyAccesses();
+      for (size_t i = 0; i < num_frames_; i++) {
+        page_id_t page_id = pages_[i].page_id_;
+        if (page_id < first_page_id || page_id > last_page_id) continue;
+        // a pinned frame is being written back or read in, it is dropped on the next pass
+        if (!LockFrame(i)) {
+          busy = true;
+          continue;
+        }
+        DropFrame(i);
+      }
+    }
+    if (busy) this_thread::yield();
+  }
+}
+
+void BufferPoolManager::DropSpace(space_id_t space_id) {
+  page_id_t first_page_id = DiskManager::MakePageId(space_id, 0);
+  DiscardPages(first_page_id, first_page_id + (DiskManager::SPACE_PAGES - 1));
+  disk_manager_->DropSpace(space_id);
+}
+
 /**
  * TODO: Student Implement
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-  // auto it = std::find(page_table_.begin(), page_table_.end(), page_id);
-  // LOG(INFO) << "page_id = " << page_id << "page_table_.count(page_id) = " << page_table_.count(page_id);
-  if (page_table_.count(page_id) == 0) return false; // if the page does not exist
-  frame_id_t frame_id = page_table_[page_id];
-  Page* target = &(pages_[frame_id]);
-  if (--target->pin_count_ == 0) { // if no more procedure pin this page, add it to the replaceList
-    replacer_->Unpin(frame_id);
-  }  
-  if (is_dirty) target->is_dirty_ = true; 
-  return true;
+  // a pinned page cannot move to another frame, so the lock-free lookup is enough unless it misses
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id) || pages_[frame_id].page_id_ != page_id) {
+    scoped_lock<recursive_mutex> lock(latch_);
+    if (!page_table_.Find(page_id, &frame_id)) return false; // if the page does not exist
+  }
+  return UnpinFrame(frame_id, is_dirty);
 }
 
 /**
  * TODO: Student Implement
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  // auto it = std::find(page_table_.begin(), page_table_.end(), page_id);
-  if (page_table_.count(page_id) == 0) return false; // the page does not exist
-  frame_id_t frame_id = page_table_[page_id];
+  scoped_lock<recursive_mutex> lock(latch_);
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) return false; // the page does not exist
   Page* target = &(pages_[frame_id]);
+  // a page that is being read in is the same as on disk
+  if (target->pin_count_ < 0) return true;
   disk_manager_->WritePage(page_id, target->data_);
   return true;
 }
 
+frame_id_t BufferPoolManager::TryToFindFreePage() {
+  frame_id_t frame_id = INVALID_FRAME_ID;
+  // pages are always found from the free list first
+  if (!free_list_.empty()) {
+    frame_id = free_list_.front();
+    free_list_.pop_front();
+    return frame_id;
+  }
+  while (replacer_->Size() > 0 && replacer_->Victim(&frame_id)) {
+    // a lock-free fetch may have pinned the victim before its access reached the replacer, the frame goes back to
+    // the replacer once it is unpinned again
+    if (LockFrame(frame_id)) {
+      EvictPage(frame_id);
+      if (static_cast<size_t>(frame_id) < pool_size_) return frame_id;
+      RetireFrame(frame_id);
+    }
+  }
+  return TryToFindUnpinnedFrame();
+}
+
+frame_id_t BufferPoolManager::TryToFindUnpinnedFrame() {
+  // the unpin of such a frame is still queued in the batch of a thread that has not taken the latch since, or was lost
+  // with a thread that exited; the batch entry is skipped later as the frame has been replaced by then
+  for (size_t i = 0; i < num_frames_; i++) {
+    auto frame_id = static_cast<frame_id_t>(scan_pos_);
+    scan_pos_ = (scan_pos_ + 1) % num_frames_;
+    if (pages_[frame_id].page_id_ == INVALID_PAGE_ID || !LockFrame(frame_id)) continue;
+    replacer_->Remove(frame_id);
+    EvictPage(frame_id);
+    if (static_cast<size_t>(frame_id) < pool_size_) return frame_id;
+    RetireFrame(frame_id);
+  }
+  return INVALID_FRAME_ID;
+}
+
+frame_id_t BufferPoolManager::TryToFindRingPage(page_id_t page_id) {
+  if (ring_frames_.empty()) return TryToFindFreePage();
+  size_t slot = ring_pos_;
+  ring_pos_ = (ring_pos_ + 1) % ring_frames_.size();
+  frame_id_t frame_id = ring_frames_[slot];
+  // recycle the frame if it still holds the page this ring read into it and nobody is using it
+  if (frame_id != INVALID_FRAME_ID) {
+    frame_id_t cur_frame_id;
+    if (page_table_.Find(ring_pages_[slot], &cur_frame_id) && cur_frame_id == frame_id && LockFrame(frame_id)) {
+      replacer_->Remove(frame_id);
+      EvictPage(frame_id);
+      ring_pages_[slot] = page_id;
+      return frame_id;
+    }
+  }
+  // otherwise grow the ring with a frame from the shared pool
+  frame_id = TryToFindFreePage();
+  ring_frames_[slot] = frame_id;
+  ring_pages_[slot] = frame_id == INVALID_FRAME_ID ? INVALID_PAGE_ID : page_id;
+  return frame_id;
+}
+
+void BufferPoolManager::EvictPage(frame_id_t frame_id) {
+  Page *replacePage = &(pages_[frame_id]);
+  // if the page to be replaced is dirty, write it back to the disk
+  if (replacePage->IsDirty()) {
+    disk_manager_->WritePage(replacePage->page_id_, replacePage->data_);
+    MarkClean(frame_id);
+  }
+  // remove the replacePage from the page table
+  page_table_.Erase(replacePage->page_id_);
+}
+
+bool BufferPoolManager::TryPinFrame(frame_id_t frame_id, page_id_t page_id) {
+  Page *page = &(pages_[frame_id]);
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count < 0) return false; // the frame is free or being replaced
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+  // the frame may have been replaced between the lookup and the pin
+  if (page->page_id_ != page_id) {
+    UnpinFrame(frame_id, false);
+    return false;
+  }
+  return true;
+}
+
+bool BufferPoolManager::UnpinFrame(frame_id_t frame_id, bool is_dirty) {
+  Page *target = &(pages_[frame_id]);
+  page_id_t page_id = target->page_id_;
+  int pin_count = target->pin_count_.load();
+  if (pin_count <= 0) return false;
+  // the dirty flag must be visible before the frame can be evicted
+  if (is_dirty) MarkDirty(frame_id);
+  do {
+    if (pin_count <= 0) return false;
+  } while (!target->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count == 1) { // if no more procedure pin this page, add it to the replaceList
+    RecordAccess(frame_id, page_id, true);
+  }
+  return true;
+}
+
+bool BufferPoolManager::LockFrame(frame_id_t frame_id) {
+  int unpinned = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(unpinned, Page::FRAME_LOCKED);
+}
+
+void BufferPoolManager::RecordAccess(frame_id_t frame_id, page_id_t page_id, bool unpin) {
+  AccessBatch &batch = access_batches[instance_id_];
+  batch.accesses[batch.size++] = {frame_id, page_id, unpin};
+  if (batch.size == ACCESS_BATCH_SIZE) {
+    scoped_lock<recursive_mutex> lock(latch_);
+    ApplyAccesses();
+  }
+}
+
+void BufferPoolManager::ApplyAccesses() {
+  auto it = access_batches.find(instance_id_);
+  if (it == access_batches.end()) return;
+  AccessBatch &batch = it->second;
+  for (size_t i = 0; i < batch.size; i++) {
+    const FrameAccess &access = batch.accesses[i];
+    Page *page = &(pages_[access.frame_id]);
+    // skip accesses to pages that have been replaced since
+    if (page->page_id_ != access.page_id || page->pin_count_ < 0) continue;
+    if (!access.unpin) replacer_->Pin(access.frame_id);
+    // the pin count may have changed after the access was queued, a frame only becomes evictable if it is unpinned
+    // now, a later unpin queues another access otherwise
+    if (page->pin_count_ != 0) continue;
+    if (static_cast<size_t>(access.frame_id) < pool_size_) {
+      replacer_->Unpin(access.frame_id);
+    } else if (LockFrame(access.frame_id)) { // the pool has shrunk below this frame while it was pinned
+      replacer_->Remove(access.frame_id);
+      EvictPage(access.frame_id);
+      RetireFrame(access.frame_id);
+    }
+  }
+  batch.size = 0;
+}
+
+void BufferPoolManager::MarkDirty(frame_id_t frame_id) {
+  if (pages_[frame_id].is_dirty_.exchange(true)) return;
+  {
+    scoped_lock<mutex> lock(dirty_latch_);
+    dirty_frames_.push_back(frame_id);
+  }
+  if (++num_dirty_ > dirty_ratio_target_ * pool_size_) {
+    flusher_cv_.notify_one();
+  }
+}
+
+void BufferPoolManager::MarkClean(frame_id_t frame_id) {
+  if (pages_[frame_id].is_dirty_.exchange(false)) {
+    num_dirty_--;
+  }
+}
+
+void BufferPoolManager::FlusherLoop() {
+  unique_lock<mutex> lock(flusher_latch_);
+  while (!stop_flusher_) {
+    flusher_cv_.wait_for(lock, chrono::milliseconds(FLUSHER_INTERVAL_MS));
+    if (stop_flusher_) break;
+    lock.unlock();
+    FlushDirtyPages();
+    lock.lock();
+  }
+}
+
+void BufferPoolManager::FlushDirtyPages() {
+  size_t target = static_cast<size_t>(dirty_ratio_target_ * pool_size_);
+  vector<frame_id_t> dirty_frames;
+  {
+    scoped_lock<mutex> lock(dirty_latch_);
+    dirty_frames.swap(dirty_frames_);
+  }
+  vector<Page *> writes;
+  vector<frame_id_t> remaining;
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    ApplyAccesses();
+    size_t num_dirty = num_dirty_;
+    size_t excess = num_dirty > target ? num_dirty - target : 0;
+    vector<bool> seen(num_frames_, false);
+    // the dirty list is in the order the frames became dirty, so the longest dirty pages are written first
+    for (frame_id_t frame_id : dirty_frames) {
+      Page *page = &(pages_[frame_id]);
+      if (seen[frame_id] || !page->is_dirty_) continue; // cleaned by an eviction or listed twice
+      seen[frame_id] = true;
+      if (writes.size() < excess && page->pin_count_ == 0) {
+        // the flusher's pin keeps the frame from being replaced while it is written, but does not count as an access
+        page->pin_count_++;
+        writes.push_back(page);
+      } else {
+        remaining.push_back(frame_id);
+      }
+    }
+  }
+  {
+    scoped_lock<mutex> lock(dirty_latch_);
+    remaining.insert(remaining.end(), dirty_frames_.begin(), dirty_frames_.end());
+    dirty_frames_.swap(remaining);
+  }
+  WriteBackPages(writes);
+}
+
+void BufferPoolManager::FlushAllPages() {
+  vector<Page *> pages;
+  PinDirtyPages(&pages);
+  WriteBackPages(pages);
+}
+
+void BufferPoolManager::Checkpoint() {
+  // the data pages first, the disk manager then records their allocation
+  FlushAllPages();
+  disk_manager_->FlushMetaData();
+}
+
+void BufferPoolManager::PinDirtyPages(vector<Page *> *pages) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  ApplyAccesses();
+  for (size_t i = 0; i < num_frames_; i++) {
+    Page *page = &(pages_[i]);
+    // locked frames are free or being read in, neither is dirty
+    if (!page->is_dirty_ || page->pin_count_ < 0) continue;
+    // the writer's pin keeps the frame from being replaced while it is written, but does not count as an access
+    page->pin_count_++;
+    pages->push_back(page);
+  }
+}
+
+void BufferPoolManager::WriteBackPages(vector<Page *> &pages) {
+  if (pages.empty()) return;
+  // write in page id order, so that consecutive pages reach the disk with one vectored write
+  sort(pages.begin(), pages.end(), [](Page *a, Page *b) { return a->page_id_ < b->page_id_; });
+  // clear the flags first, a modification made during the write marks the page dirty again; the pages count as dirty
+  // until they are written and unpinned
+  vector<bool> cleaned(pages.size());
+  for (size_t i = 0; i < pages.size(); i++) {
+    cleaned[i] = pages[i]->is_dirty_.exchange(false);
+    pages[i]->RLatch();
+  }
+  mutex done_latch;
+  condition_variable done_cv;
+  size_t pending = 0;
+  vector<const char *> run;
+  for (size_t i = 0, j; i < pages.size(); i = j) {
+    for (j = i + 1; j < pages.size() && pages[j]->page_id_ == pages[j - 1]->page_id_ + 1; j++) {
+    }
+    if (j - i > 1) {
+      run.clear();
+      for (size_t k = i; k < j; k++) {
+        run.push_back(pages[k]->data_);
+      }
+      disk_manager_->WritePages(pages[i]->page_id_, run.size(), run.data());
+      continue;
+    }
+    {
+      scoped_lock<mutex> lock(done_latch);
+      pending++;
+    }
+    disk_manager_->WritePageAsync(pages[i]->page_id_, pages[i]->data_, [&] {
+      scoped_lock<mutex> lock(done_latch);
+      if (--pending == 0) done_cv.notify_one();
+    });
+  }
+  {
+    unique_lock<mutex> lock(done_latch);
+    done_cv.wait(lock, [&] { return pending == 0; });
+  }
+  vector<BufferPoolManager *> instances;
+  for (size_t i = 0; i < pages.size(); i++) {
+    pages[i]->RUnlatch();
+    BufferPoolManager *instance = GetInstance(pages[i]->page_id_);
+    instance->UnpinFrame(instance->GetFrameId(pages[i]), false);
+    if (cleaned[i]) instance->num_dirty_--;
+    if (find(instances.begin(), instances.end(), instance) == instances.end()) instances.push_back(instance);
+  }
+  // the unpins were queued by this thread, hand them to the replacers now
+  for (auto instance : instances) {
+    scoped_lock<recursive_mutex> lock(instance->latch_);
+    instance->ApplyAccesses();
+  }
+}
+
+void BufferPoolManager::PrefetchPages(const vector<page_id_t> &page_ids, bool bulk_read) {
+  // consecutive pages are read together
+  for (size_t i = 0, j; i < page_ids.size(); i = j) {
+    for (j = i + 1; j < page_ids.size() && j - i < PREFETCH_RUN_PAGES && page_ids[j] == page_ids[j - 1] + 1; j++) {
+    }
+    SubmitPrefetch({page_ids[i], j - i, bulk_read});
+  }
+}
+
+void BufferPoolManager::SubmitPrefetch(PrefetchRequest request) {
+  {
+    scoped_lock<mutex> lock(prefetch_latch_);
+    if (stop_prefetch_) return;
+    if (io_threads_.empty()) {
+      for (int i = 0; i < PREFETCH_IO_THREADS; i++) {
+        io_threads_.emplace_back(&BufferPoolManager::PrefetchLoop, this);
+      }
+    }
+    prefetch_queue_.push_back(move(request));
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::PrefetchLoop() {
+  unique_lock<mutex> lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return stop_prefetch_ || !prefetch_queue_.empty(); });
+    if (stop_prefetch_) return;
+    PrefetchRequest request = move(prefetch_queue_.front());
+    prefetch_queue_.pop_front();
+    lock.unlock();
+    PrefetchRun(request.page_id, request.count, request.bulk_read);
+    lock.lock();
+  }
+}
+
+void BufferPoolManager::PrefetchRun(page_id_t first_page_id, size_t count, bool bulk_read) {
+  vector<Page *> frames(count);
+  for (size_t i = 0; i < count; i++) {
+    frames[i] = GetInstance(first_page_id + i)->ReserveFrame(first_page_id + i, bulk_read);
+  }
+  // read the pages that were not resident, consecutive ones together
+  vector<char *> run;
+  for (size_t i = 0, j; i < count; i = j) {
+    for (j = i; j < count && frames[j] != nullptr; j++) {
+    }
+    if (j == i) {
+      j++;
+      continue;
+    }
+    run.clear();
+    for (size_t k = i; k < j; k++) {
+      run.push_back(frames[k]->data_);
+    }
+    disk_manager_->ReadPages(first_page_id + i, run.size(), run.data());
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (frames[i] != nullptr) GetInstance(first_page_id + i)->PublishFrame(frames[i]);
+  }
+}
+
+Page *BufferPoolManager::ReserveFrame(page_id_t page_id, bool bulk_read) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  ApplyAccesses();
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) return nullptr;
+  frame_id = bulk_read ? TryToFindRingPage(page_id) : TryToFindFreePage();
+  if (frame_id == INVALID_FRAME_ID) return nullptr;
+  pages_[frame_id].page_id_ = page_id;
+  MarkClean(frame_id);
+  page_table_.Insert(page_id, frame_id);
+  return &(pages_[frame_id]);
+}
+
+void BufferPoolManager::PublishFrame(Page *page) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  frame_id_t frame_id = GetFrameId(page);
+  if (static_cast<size_t>(frame_id) >= pool_size_) { // the pool has shrunk below this frame while it was read in
+    page_table_.Erase(page->page_id_);
+    RetireFrame(frame_id);
+    return;
+  }
+  // nobody uses the page yet, so the replacer may take it back right away
+  replacer_->Unpin(frame_id);
+  page->pin_count_ = 0;
+}
+
+void BufferPoolManager::StopPrefetchThreads() {
+  {
+    scoped_lock<mutex> lock(prefetch_latch_);
+    stop_prefetch_ = true;
+    prefetch_queue_.clear();
+  }
+  prefetch_cv_.notify_all();
+  for (auto &io_thread : io_threads_) {
+    io_thread.join();
+  }
+  io_threads_.clear();
+}
+
+vector<page_id_t> BufferPoolManager::DrainResidentPages() {
+  scoped_lock<recursive_mutex> lock(latch_);
+  ApplyAccesses();
+  // victims come coldest first, frames that are not in the replacer are pinned and count as the hottest
+  vector<page_id_t> page_ids;
+  vector<bool> drained(num_frames_, false);
+  frame_id_t frame_id;
+  while (replacer_->Size() > 0 && replacer_->Victim(&frame_id)) {
+    drained[frame_id] = true;
+    if (pages_[frame_id].page_id_ != INVALID_PAGE_ID) page_ids.push_back(pages_[frame_id].page_id_);
+  }
+  for (size_t i = 0; i < num_frames_; i++) {
+    if (!drained[i] && pages_[i].page_id_ != INVALID_PAGE_ID) page_ids.push_back(pages_[i].page_id_);
+  }
+  reverse(page_ids.begin(), page_ids.end());
+  return page_ids;
+}
+
+void BufferPoolManager::SaveResidentPages() {
+  if (resident_pages_file_.empty()) return;
+  vector<page_id_t> page_ids = DrainResidentPages();
+  ofstream out(resident_pages_file_, ios::binary | ios::trunc);
+  uint32_t count = page_ids.size();
+  out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+  out.write(reinterpret_cast<const char *>(page_ids.data()), count * sizeof(page_id_t));
+  if (!out) {
+    LOG(WARNING) << "Failed to save resident pages to " << resident_pages_file_;
+  }
+}
+
+size_t BufferPoolManager::PreloadResidentPages(const string &file_name) {
+  ifstream in(file_name, ios::binary);
+  if (!in) return 0;
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char *>(&count), sizeof(count));
+  vector<page_id_t> page_ids(count);
+  in.read(reinterpret_cast<char *>(page_ids.data()), count * sizeof(page_id_t));
+  in.close();
+  // the file only describes the last clean shutdown, do not preload it again after a crash
+  remove(file_name.c_str());
+  if (!in) return 0;
+  // keep the hottest pages that fit, and read them in page id order
+  page_ids.resize(min(page_ids.size(), GetPoolSize()));
+  sort(page_ids.begin(), page_ids.end());
+  PrefetchPages(page_ids);
+  return page_ids.size();
+}
+
 page_id_t BufferPoolManager::AllocatePage() {
-  int next_page_id = disk_manager_->AllocatePage();
+  page_id_t next_page_id = disk_manager_->AllocatePage();
   return next_page_id;
 }
 
@@ -218,14 +758,90 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
   return disk_manager_->IsPageFree(page_id);
 }
 
+bool BufferPoolManager::IsPageResident(page_id_t page_id) {
+  frame_id_t frame_id;
+  return page_table_.Find(page_id, &frame_id);
+}
+
+bool BufferPoolManager::Resize(size_t pool_size) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  ApplyAccesses();
+  if (pool_size == 0 || pool_size > arena_.MaxFrames()) return false;
+  size_t old_pool_size = pool_size_;
+  if (pool_size > old_pool_size) {
+    page_table_.Reserve(pool_size);
+    // frames retired by an earlier shrink are reused, frames still waiting to retire simply stay in use
+    for (size_t i = old_pool_size; i < min(pool_size, num_frames_); i++) {
+      if (pages_[i].page_id_ == INVALID_PAGE_ID) free_list_.push_back(i);
+    }
+    pool_size_ = pool_size;
+    AddFrames(pool_size);
+  } else if (pool_size < old_pool_size) {
+    pool_size_ = pool_size;
+    for (auto it = free_list_.begin(); it != free_list_.end();) {
+      if (static_cast<size_t>(*it) >= pool_size) {
+        RetireFrame(*it);
+        it = free_list_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    // pinned frames retire once they are unpinned
+    for (size_t i = pool_size; i < old_pool_size; i++) {
+      if (pages_[i].page_id_ != INVALID_PAGE_ID && LockFrame(i)) {
+        replacer_->Remove(i);
+        EvictPage(i);
+        RetireFrame(i);
+      }
+    }
+  }
+  ResetRing();
+  return true;
+}
+
+size_t BufferPoolManager::GetPoolSize() { return pool_size_; }
+
+void BufferPoolManager::AddFrames(size_t num_frames) {
+  if (num_frames <= num_frames_) return;
+  arena_.Grow(num_frames);
+  for (size_t i = num_frames_; i < num_frames; i++) {
+    new (&pages_[i]) Page(arena_.FrameData(i), disk_manager_->GetPageSize());
+    pages_[i].pin_count_ = Page::FRAME_LOCKED;  // free frames cannot be pinned
+    free_list_.emplace_back(i);
+  }
+  num_frames_ = num_frames;
+}
+
+void BufferPoolManager::RetireFrame(frame_id_t frame_id) {
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  arena_.Discard(frame_id);
+}
+
+void BufferPoolManager::ResetRing() {
+  // the bulk read ring never takes more than 1/8 of the pool
+  size_t ring_size = min(static_cast<size_t>(BULK_READ_RING_SIZE), pool_size_ / 8);
+  ring_frames_.assign(ring_size, INVALID_FRAME_ID);
+  ring_pages_.assign(ring_size, INVALID_PAGE_ID);
+  ring_pos_ = 0;
+}
+
+void BufferPoolManager::SetDirtyRatioTarget(double dirty_ratio_target) {
+  dirty_ratio_target_ = dirty_ratio_target;
+  flusher_cv_.notify_one();
+}
+
+size_t BufferPoolManager::DirtyPageCount() { return num_dirty_; }
+
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
+  scoped_lock<recursive_mutex> lock(latch_);
+  ApplyAccesses();
   bool res = true;
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].pin_count_ != 0) {
+  for (size_t i = 0; i < num_frames_; i++) {
+    if (pages_[i].pin_count_ > 0) {
       res = false;
       LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
     }
   }
   return res;
-}
\ No newline at end of file
+}
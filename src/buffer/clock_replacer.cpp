@@ -35,6 +35,13 @@ void ClockReplacer::Pin(frame_id_t frame_id) {
 }
 
 void ClockReplacer::Unpin(frame_id_t frame_id) {
+  // a frame that is already in the clock only gets its reference bit back
+  for (size_t i = 0; i < num_pages_; ++i) {
+    if (frames_[i] == frame_id) {
+      reference_bits_[i] = true;
+      return;
+    }
+  }
   for (size_t i = 0; i < num_pages_; ++i) {
     if (frames_[i] == -1) {
       frames_[i] = frame_id;
@@ -42,8 +49,14 @@ void ClockReplacer::Unpin(frame_id_t frame_id) {
       return;
     }
   }
+  // the buffer pool has grown beyond the clock
+  frames_.push_back(frame_id);
+  reference_bits_.push_back(true);
+  num_pages_++;
 }
 
+void ClockReplacer::Remove(frame_id_t frame_id) { Pin(frame_id); }
+
 size_t ClockReplacer::Size() {
   size_t size = 0;
   for (size_t i = 0; i < num_pages_; ++i) {
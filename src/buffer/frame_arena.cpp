@@ -0,0 +1,33 @@
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <new>
+
+FrameArena::FrameArena(size_t max_frames, size_t frame_size, bool huge_pages)
+    : max_frames_(max_frames), frame_size_(frame_size), huge_pages_(huge_pages) {
+  if (max_frames_ == 0) return;
+  // reserve the address range only, memory is committed frame by frame in Grow
+  void *data = mmap(nullptr, max_frames_ * frame_size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (data == MAP_FAILED) throw std::bad_alloc();
+  data_ = static_cast<char *>(data);
+}
+
+FrameArena::~FrameArena() {
+  if (data_ != nullptr) munmap(data_, max_frames_ * frame_size_);
+}
+
+void FrameArena::Grow(size_t num_frames) {
+  ASSERT(num_frames <= max_frames_, "Frame arena is too small.");
+  if (num_frames <= num_frames_) return;
+  // anonymous memory is page aligned and zero filled
+  char *start = FrameData(num_frames_);
+  size_t size = (num_frames - num_frames_) * frame_size_;
+  if (mprotect(start, size, PROT_READ | PROT_WRITE) != 0) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+  if (huge_pages_) madvise(start, size, MADV_HUGEPAGE);
+#endif
+  num_frames_ = num_frames;
+}
+
+void FrameArena::Discard(frame_id_t frame_id) { madvise(FrameData(frame_id), frame_size_, MADV_DONTNEED); }
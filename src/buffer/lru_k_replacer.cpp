@@ -0,0 +1,90 @@
+#include "buffer/lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : k_(k), history_(num_pages), evictable_(num_pages, false) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  // frames with an infinite backward k-distance go first
+  set<EvictionKey> &victims = cold_.empty() ? hot_ : cold_;
+  if (victims.empty()) return false;
+  *frame_id = victims.begin()->second;
+  victims.erase(victims.begin());
+  evictable_[*frame_id] = false;
+  // the frame will hold another page, so its history no longer applies
+  history_[*frame_id].clear();
+  if (last_accessed_ == *frame_id) {
+    last_accessed_ = INVALID_FRAME_ID;
+  }
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  if (frame_id < 0) return;
+  Reserve(frame_id);
+  if (evictable_[frame_id]) {
+    EvictionKey key;
+    EvictableSet(frame_id, &key).erase(key);
+    evictable_[frame_id] = false;
+  }
+  RecordAccess(frame_id);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  if (frame_id < 0) return;
+  Reserve(frame_id);
+  if (evictable_[frame_id]) return;
+  // a frame handed to the replacer without ever being pinned is accessed now
+  if (history_[frame_id].empty()) {
+    RecordAccess(frame_id);
+  }
+  EvictionKey key;
+  EvictableSet(frame_id, &key).insert(key);
+  evictable_[frame_id] = true;
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= history_.size()) return;
+  if (evictable_[frame_id]) {
+    EvictionKey key;
+    EvictableSet(frame_id, &key).erase(key);
+    evictable_[frame_id] = false;
+  }
+  history_[frame_id].clear();
+  if (last_accessed_ == frame_id) {
+    last_accessed_ = INVALID_FRAME_ID;
+  }
+}
+
+size_t LRUKReplacer::Size() { return cold_.size() + hot_.size(); }
+
+// used for debug
+size_t LRUKReplacer::TotalSize() { return history_.size(); }
+
+void LRUKReplacer::Reserve(frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) < history_.size()) return;
+  history_.resize(frame_id + 1);
+  evictable_.resize(frame_id + 1, false);
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  auto &history = history_[frame_id];
+  current_timestamp_++;
+  if (last_accessed_ == frame_id && !history.empty()) {
+    // correlated reference, only refresh the latest access
+    history.back() = current_timestamp_;
+    return;
+  }
+  last_accessed_ = frame_id;
+  if (history.size() == k_) {
+    history.erase(history.begin());
+  }
+  history.push_back(current_timestamp_);
+}
+
+set<LRUKReplacer::EvictionKey> &LRUKReplacer::EvictableSet(frame_id_t frame_id, EvictionKey *key) {
+  // history is ordered oldest first, so its front is the first access of a cold frame
+  // and the k-th most recent access of a hot one
+  *key = make_pair(history_[frame_id].front(), frame_id);
+  return history_[frame_id].size() < k_ ? cold_ : hot_;
+}
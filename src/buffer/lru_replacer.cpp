@@ -1,57 +1,71 @@
 #include "buffer/lru_replacer.h"
-#include <algorithm>
 
-LRUReplacer::LRUReplacer(size_t num_pages) {
-  for (frame_id_t i = 0; i < num_pages; i++) {
-    irreplaceList.push_back(i);
-  }
-}
+LRUReplacer::LRUReplacer(size_t num_pages)
+    : prev_(num_pages, INVALID_FRAME_ID), next_(num_pages, INVALID_FRAME_ID), in_list_(num_pages, false) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-/**
- * TODO: Student Implement
- */
 bool LRUReplacer::Victim(frame_id_t *frame_id) {
-  if (this->Size() == 0) return false;
-  else {
-    *frame_id = replaceList.front();
-    irreplaceList.push_back(*frame_id);
-    replaceList.remove(replaceList.front());
-  }
+  if (size_ == 0) return false;
+  *frame_id = head_;
+  Unlink(head_);
   return true;
 }
 
-/**
- * TODO: Student Implement
- */
 void LRUReplacer::Pin(frame_id_t frame_id) {
-  auto it = std::find(replaceList.begin(), replaceList.end(), frame_id);
-  if (it != replaceList.end()) { 
-    replaceList.erase(it);
-    irreplaceList.push_back(frame_id);
-  }
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= in_list_.size() || !in_list_[frame_id]) return;
+  Unlink(frame_id);
 }
 
-/**
- * TODO: Student Implement
- */
 void LRUReplacer::Unpin(frame_id_t frame_id) {
-  auto it = std::find(irreplaceList.begin(), irreplaceList.end(), frame_id);
-  if (it != irreplaceList.end()) {
-    irreplaceList.erase(it);
-    replaceList.push_back(frame_id);
-  }
+  if (frame_id < 0) return;
+  Reserve(frame_id);
+  // a frame that is already victimizable keeps its position
+  if (in_list_[frame_id]) return;
+  PushBack(frame_id);
 }
 
-/**
- * TODO: Student Implement
- */
-size_t LRUReplacer::Size() {
-  return replaceList.size();
-}
+void LRUReplacer::Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+size_t LRUReplacer::Size() { return size_; }
 
 // used for debug
-size_t LRUReplacer::TotalSize() {
-  return replaceList.size() + irreplaceList.size();
-}
\ No newline at end of file
+size_t LRUReplacer::TotalSize() { return in_list_.size(); }
+
+void LRUReplacer::Reserve(frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) < in_list_.size()) return;
+  prev_.resize(frame_id + 1, INVALID_FRAME_ID);
+  next_.resize(frame_id + 1, INVALID_FRAME_ID);
+  in_list_.resize(frame_id + 1, false);
+}
+
+void LRUReplacer::PushBack(frame_id_t frame_id) {
+  prev_[frame_id] = tail_;
+  next_[frame_id] = INVALID_FRAME_ID;
+  if (tail_ != INVALID_FRAME_ID) {
+    next_[tail_] = frame_id;
+  } else {
+    head_ = frame_id;
+  }
+  tail_ = frame_id;
+  in_list_[frame_id] = true;
+  size_++;
+}
+
+void LRUReplacer::Unlink(frame_id_t frame_id) {
+  frame_id_t prev = prev_[frame_id];
+  frame_id_t next = next_[frame_id];
+  if (prev != INVALID_FRAME_ID) {
+    next_[prev] = next;
+  } else {
+    head_ = next;
+  }
+  if (next != INVALID_FRAME_ID) {
+    prev_[next] = prev;
+  } else {
+    tail_ = prev;
+  }
+  prev_[frame_id] = next_[frame_id] = INVALID_FRAME_ID;
+  in_list_[frame_id] = false;
+  size_--;
+}
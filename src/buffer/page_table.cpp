@@ -0,0 +1,88 @@
+#include "buffer/page_table.h"
+
+PageTable::Slots::Slots(size_t num_frames) {
+  size_t capacity = 16;
+  while (capacity < num_frames * 2) {
+    capacity <<= 1;
+  }
+  mask_ = capacity - 1;
+  slots_.reset(new std::atomic<uint64_t>[capacity]);
+  for (size_t i = 0; i < capacity; i++) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+PageTable::PageTable(size_t num_frames) {
+  tables_.emplace_back(new Slots(num_frames));
+  current_.store(tables_.back().get(), std::memory_order_release);
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  const Slots *table = current_.load(std::memory_order_acquire);
+  for (size_t i = Home(page_id, table->mask_);; i = (i + 1) & table->mask_) {
+    uint64_t slot = table->slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) return false;
+    if (SlotPageId(slot) == page_id) {
+      *frame_id = SlotFrameId(slot);
+      return true;
+    }
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  Slots *table = current_.load(std::memory_order_relaxed);
+  for (size_t i = Home(page_id, table->mask_);; i = (i + 1) & table->mask_) {
+    uint64_t slot = table->slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT || SlotPageId(slot) == page_id) {
+      if (slot == EMPTY_SLOT) size_++;
+      table->slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+}
+
+bool PageTable::Erase(page_id_t page_id) {
+  Slots *table = current_.load(std::memory_order_relaxed);
+  size_t mask = table->mask_;
+  size_t hole = Home(page_id, mask);
+  for (;; hole = (hole + 1) & mask) {
+    uint64_t slot = table->slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) return false;
+    if (SlotPageId(slot) == page_id) break;
+  }
+  // shift the rest of the probe chain back so no tombstone is needed
+  for (size_t next = (hole + 1) & mask;; next = (next + 1) & mask) {
+    uint64_t slot = table->slots_[next].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) break;
+    size_t home = Home(SlotPageId(slot), mask);
+    // the entry may only move back if its home slot is not inside (hole, next]
+    bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+    if (movable) {
+      table->slots_[hole].store(slot, std::memory_order_release);
+      hole = next;
+    }
+  }
+  table->slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+  size_--;
+  return true;
+}
+
+void PageTable::Reserve(size_t num_frames) {
+  Slots *table = current_.load(std::memory_order_relaxed);
+  if (table->mask_ + 1 >= num_frames * 2) return;
+  auto *grown = new Slots(num_frames);
+  for (size_t i = 0; i <= table->mask_; i++) {
+    uint64_t slot = table->slots_[i].load(std::memory_order_relaxed);
+    if (slot != EMPTY_SLOT) InsertInto(grown, slot);
+  }
+  tables_.emplace_back(grown);
+  current_.store(grown, std::memory_order_release);
+}
+
+void PageTable::InsertInto(Slots *table, uint64_t slot) {
+  size_t i = Home(SlotPageId(slot), table->mask_);
+  while (table->slots_[i].load(std::memory_order_relaxed) != EMPTY_SLOT) {
+    i = (i + 1) & table->mask_;
+  }
+  table->slots_[i].store(slot, std::memory_order_relaxed);
+}
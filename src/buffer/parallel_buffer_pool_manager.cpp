@@ -0,0 +1,130 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size)
+    : BufferPoolManager(disk_manager) {
+  ASSERT(num_instances > 0, "Need at least one buffer pool instance.");
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.push_back(new BufferPoolManager(pool_size, disk_manager, replacer_type, max_pool_size));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  // the I/O threads of this pool work on the instances
+  StopPrefetchThreads();
+  SaveResidentPages();
+  FlushAllPages();
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id, bool bulk_read) {
+  return GetInstance(page_id)->FetchPage(page_id, bulk_read);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) { return GetInstance(page_id)->FlushPage(page_id); }
+
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id) {
+  // start at the next instance in turn, and move on to the others if all frames of one are pinned
+  size_t num_instances = instances_.size();
+  size_t start = next_instance_++;
+  for (size_t i = 0; i < num_instances; i++) {
+    size_t index = (start + i) % num_instances;
+    // the page id decides the instance, so allocate it from the ids routed to this instance
+    page_id = disk_manager_->AllocatePageInClass(num_instances, index);
+    if (page_id == INVALID_PAGE_ID) continue;
+    Page *page = instances_[index]->NewPageWithId(page_id);
+    if (page != nullptr) return page;
+    disk_manager_->DeAllocatePage(page_id);  // every frame of that instance is pinned, give the page back
+  }
+  page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) { return GetInstance(page_id)->DeletePage(page_id); }
+
+void ParallelBufferPoolManager::DiscardPages(page_id_t first_page_id, page_id_t last_page_id) {
+  for (auto instance : instances_) {
+    instance->DiscardPages(first_page_id, last_page_id);
+  }
+}
+
+bool ParallelBufferPoolManager::IsPageFree(page_id_t page_id) { return disk_manager_->IsPageFree(page_id); }
+
+// Only used for debug
+bool ParallelBufferPoolManager::CheckAllUnpinned() {
+  bool res = true;
+  for (auto instance : instances_) {
+    res = instance->CheckAllUnpinned() && res;
+  }
+  return res;
+}
+
+bool ParallelBufferPoolManager::IsPageResident(page_id_t page_id) {
+  return GetInstance(page_id)->IsPageResident(page_id);
+}
+
+void ParallelBufferPoolManager::SetDirtyRatioTarget(double dirty_ratio_target) {
+  for (auto instance : instances_) {
+    instance->SetDirtyRatioTarget(dirty_ratio_target);
+  }
+}
+
+size_t ParallelBufferPoolManager::DirtyPageCount() {
+  size_t count = 0;
+  for (auto instance : instances_) {
+    count += instance->DirtyPageCount();
+  }
+  return count;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t pool_size) {
+  size_t num_instances = instances_.size();
+  if (pool_size < num_instances) return false;
+  bool res = true;
+  for (size_t i = 0; i < num_instances; i++) {
+    res = instances_[i]->Resize(pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0)) && res;
+  }
+  return res;
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+vector<page_id_t> ParallelBufferPoolManager::DrainResidentPages() {
+  vector<vector<page_id_t>> instance_pages;
+  size_t max_pages = 0;
+  for (auto instance : instances_) {
+    instance_pages.push_back(instance->DrainResidentPages());
+    max_pages = max(max_pages, instance_pages.back().size());
+  }
+  vector<page_id_t> page_ids;
+  for (size_t rank = 0; rank < max_pages; rank++) {
+    for (auto &pages : instance_pages) {
+      if (rank < pages.size()) page_ids.push_back(pages[rank]);
+    }
+  }
+  return page_ids;
+}
+
+void ParallelBufferPoolManager::PinDirtyPages(vector<Page *> *pages) {
+  for (auto instance : instances_) {
+    instance->PinDirtyPages(pages);
+  }
+}
+
+BufferPoolManager *ParallelBufferPoolManager::GetInstance(page_id_t page_id) {
+  ASSERT(page_id >= 0, "Invalid page id.");
+  return instances_[page_id % instances_.size()];
+}
@@ -5,7 +5,7 @@
 #include "common/macros.h"
 
 void CatalogMeta::SerializeTo(char *buf) const {
-  ASSERT(GetSerializedSize() <= PAGE_SIZE, "Failed to serialize catalog metadata to disk.");
+  ASSERT(GetSerializedSize() <= MIN_PAGE_SIZE, "Failed to serialize catalog metadata to disk.");
   MACH_WRITE_UINT32(buf, CATALOG_METADATA_MAGIC_NUM);
   buf += 4;
   MACH_WRITE_UINT32(buf, table_meta_pages_.size());
@@ -16,13 +16,13 @@ void CatalogMeta::SerializeTo(char *buf) const {
     MACH_WRITE_TO(table_id_t, buf, iter.first);
     buf += 4;
     MACH_WRITE_TO(page_id_t, buf, iter.second);
-    buf += 4;
+    buf += sizeof(page_id_t);
   }
   for (auto iter : index_meta_pages_) {
     MACH_WRITE_TO(index_id_t, buf, iter.first);
     buf += 4;
     MACH_WRITE_TO(page_id_t, buf, iter.second);
-    buf += 4;
+    buf += sizeof(page_id_t);
   }
 }
 
@@ -42,14 +42,14 @@ CatalogMeta *CatalogMeta::DeserializeFrom(char *buf) {
     auto table_id = MACH_READ_FROM(table_id_t, buf);
     buf += 4;
     auto table_heap_page_id = MACH_READ_FROM(page_id_t, buf);
-    buf += 4;
+    buf += sizeof(page_id_t);
     meta->table_meta_pages_.emplace(table_id, table_heap_page_id);
   }
   for (uint32_t i = 0; i < index_nums; i++) {
     auto index_id = MACH_READ_FROM(index_id_t, buf);
     buf += 4;
     auto index_page_id = MACH_READ_FROM(page_id_t, buf);
-    buf += 4;
+    buf += sizeof(page_id_t);
     meta->index_meta_pages_.emplace(index_id, index_page_id);
   }
   return meta;
@@ -60,7 +60,7 @@ CatalogMeta *CatalogMeta::DeserializeFrom(char *buf) {
  */
 uint32_t CatalogMeta::GetSerializedSize() const {
   // ASSERT(false, "Not Implemented yet");
-  return 4 * 3 + table_meta_pages_.size() * 8 + index_meta_pages_.size() * 8;
+  return 4 * 3 + (table_meta_pages_.size() + index_meta_pages_.size()) * (4 + sizeof(page_id_t));
 }
 
 CatalogMeta::CatalogMeta() {}
@@ -73,6 +73,9 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
   if (init) {
     catalog_meta_ = CatalogMeta::NewInstance();
+    // the ids decide the tablespaces of the tables and indexes, so they start from 0 as well
+    next_table_id_ = 0;
+    next_index_id_ = 0;
   }
   else {
     // fetch the catalog page from the memory and deserialize the data
@@ -91,7 +94,8 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
       TableMetadata* table_meta = nullptr;
       TableMetadata::DeserializeFrom(tablePage->GetData(), table_meta);
 
-      TableHeap* table_heap = TableHeap::Create(buffer_pool_manager, table_meta->GetFirstPageId(), table_meta->GetSchema(), log_manager, lock_manager);
+      TableHeap* table_heap = TableHeap::Create(buffer_pool_manager, table_meta->GetFirstPageId(), table_meta->GetSchema(), log_manager, lock_manager,
+                                                buffer_pool_manager->GetTableSpace(table_meta->GetTableId()));
       table_info->Init(table_meta, table_heap);
       buffer_pool_manager->UnpinPage(it->second, false);
 
@@ -159,11 +163,12 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   table_info = TableInfo::Create();
   auto table_schema = TableSchema::DeepCopySchema(schema);
 
-  // create table heap
-  auto table_heap = TableHeap::Create(buffer_pool_manager_, table_schema, txn, log_manager_, lock_manager_);
+  // create table heap, in the tablespace of the table
+  auto table_id = next_table_id_.fetch_add(1);
+  auto table_heap = TableHeap::Create(buffer_pool_manager_, table_schema, txn, log_manager_, lock_manager_,
+                                      buffer_pool_manager_->GetTableSpace(table_id));
 
   // create table metadata
-  auto table_id = next_table_id_.fetch_add(1);
   auto table_meta = TableMetadata::Create(table_id, table_name, table_heap->GetFirstPageId(), table_schema);
 
   // init table info
@@ -283,6 +288,7 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   auto page = buffer_pool_manager_->NewPage(index_meta_page_id);
   ASSERT(page != nullptr, "page allocation error.");
   index_meta->SerializeTo(page->GetData());
+  buffer_pool_manager_->UnpinPage(index_meta_page_id, true);
 
   // 4 write the catalog metadata to catalog metadata page
   catalog_meta_->index_meta_pages_.emplace(index_id, index_meta_page_id);
@@ -414,7 +420,7 @@ dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_
 dberr_t CatalogManager::FlushCatalogMetaPage() const {
   // ASSERT(false, "Not Implemented yet");
   auto catalog_meta_page = buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
-  memset(catalog_meta_page->GetData(), 0, PAGE_SIZE); // reset the data to 0, in order to get new data (information for index will change when inserting records)
+  memset(catalog_meta_page->GetData(), 0, catalog_meta_page->GetPageSize()); // reset the data to 0, in order to get new data (information for index will change when inserting records)
   catalog_meta_->SerializeTo(catalog_meta_page->GetData());
   buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
   if (buffer_pool_manager_->FlushPage(CATALOG_META_PAGE_ID)) return DB_SUCCESS;
@@ -3,7 +3,7 @@
 uint32_t TableMetadata::SerializeTo(char *buf) const {
   char *p = buf;
   uint32_t ofs = GetSerializedSize();
-  ASSERT(ofs <= PAGE_SIZE, "Failed to serialize table info.");
+  ASSERT(ofs <= MIN_PAGE_SIZE, "Failed to serialize table info.");
   // magic num
   MACH_WRITE_UINT32(buf, TABLE_METADATA_MAGIC_NUM);
   buf += 4;
@@ -17,7 +17,7 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
   buf += table_name_.length();
   // table heap root page id
   MACH_WRITE_TO(page_id_t, buf, root_page_id_);
-  buf += 4;
+  buf += sizeof(page_id_t);
   // table schema
   buf += schema_->SerializeTo(buf);
   ASSERT(buf - p == ofs, "Unexpected serialize size.");
@@ -28,7 +28,7 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
  * TODO: Student Implement
  */
 uint32_t TableMetadata::GetSerializedSize() const {
-  return 4 + 4 + 4 + MACH_STR_SERIALIZED_SIZE(table_name_) + 4 + schema_->GetSerializedSize();
+  return 4 + 4 + 4 + MACH_STR_SERIALIZED_SIZE(table_name_) + sizeof(page_id_t) + schema_->GetSerializedSize();
 }
 
 /**
@@ -54,7 +54,7 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
   buf += len;
   // table heap root page id
   page_id_t root_page_id = MACH_READ_FROM(page_id_t, buf);
-  buf += 4;
+  buf += sizeof(page_id_t);
   // table schema
   TableSchema *schema = nullptr;
   buf += TableSchema::DeserializeFrom(buf, schema);
@@ -3,16 +3,32 @@
 //
 #include "common/instance.h"
 
-DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size)
+#include <filesystem>
+
+#include "storage/storage_compactor.h"
+
+DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size, bool file_per_table,
+                                 uint32_t max_buffer_pool_size, uint32_t page_size)
     : db_file_name_(std::move(db_name)), init_(init) {
+  // the resident pages file is hidden, so that it is not taken for a database of its own
+  resident_pages_file_ = "./databases/." + db_file_name_ + ".resident";
   // Init database file if needed
   db_file_name_ = "./databases/" + db_file_name_;
   if (init_) {
     remove(db_file_name_.c_str());
+    remove(CompressedPageStore::GetFileName(db_file_name_).c_str());
+    std::filesystem::remove_all(DiskManager::GetSpaceDirectory(db_file_name_));
+    remove(resident_pages_file_.c_str());
   }
   // Initialize components
-  disk_mgr_ = new DiskManager(db_file_name_);
-  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  disk_mgr_ = new DiskManager(db_file_name_, DEFAULT_DISK_IO_TYPE, false, DEFAULT_COMPRESS_PAGES, file_per_table,
+                              page_size);
+  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_, DEFAULT_REPLACER_TYPE, max_buffer_pool_size);
+  // warm the buffer pool up with the pages that were resident at the last clean shutdown
+  if (!init_) {
+    bpm_->PreloadResidentPages(resident_pages_file_);
+  }
+  bpm_->SetResidentPagesFile(resident_pages_file_);
 
   // Allocate static page for db storage engine
   if (init) {
@@ -34,6 +50,8 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
     }
     bpm_->UnpinPage(CATALOG_META_PAGE_ID, false);
     bpm_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+    // the allocation of the static pages only reaches the disk with a checkpoint
+    bpm_->Checkpoint();
   } else {
     ASSERT(!bpm_->IsPageFree(CATALOG_META_PAGE_ID), "Invalid catalog meta page.");
     ASSERT(!bpm_->IsPageFree(INDEX_ROOTS_PAGE_ID), "Invalid header page.");
@@ -42,6 +60,7 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
 }
 
 DBStorageEngine::~DBStorageEngine() {
+  delete vacuum_worker_;
   delete catalog_mgr_;
   delete bpm_;
   delete disk_mgr_;
@@ -50,3 +69,46 @@ DBStorageEngine::~DBStorageEngine() {
 std::unique_ptr<ExecuteContext> DBStorageEngine::MakeExecuteContext(Txn *txn) {
   return std::make_unique<ExecuteContext>(txn, catalog_mgr_, bpm_);
 }
+
+bool DBStorageEngine::ResizeBufferPool(size_t buffer_pool_size) { return bpm_->Resize(buffer_pool_size); }
+
+dberr_t DBStorageEngine::Compact() {
+  // a vacuum round merging pages would give tuples new row ids behind the compactor's back, Foreground keeps it out
+  auto foreground = Foreground();
+  // closing the catalog writes its meta page back and gives the pages reserved by the heaps and trees back
+  delete catalog_mgr_;
+  StorageCompactor compactor(bpm_, disk_mgr_);
+  dberr_t result = compactor.Compact();
+  catalog_mgr_ = new CatalogManager(bpm_, nullptr, nullptr, false);
+  return result;
+}
+
+void DBStorageEngine::StartVacuum() {
+  if (vacuum_worker_ != nullptr) {
+    return;
+  }
+  // the catalog only changes under Foreground, so its tables are listed anew for every round
+  vacuum_worker_ = new VacuumWorker([this](std::vector<VacuumWorker::Table> &tables) {
+    std::vector<TableInfo *> table_infos;
+    catalog_mgr_->GetTables(table_infos);
+    for (auto table_info : table_infos) {
+      // only called within a round, which holds the foreground latch exclusively, so no statement sees the row
+      // under its new row id before its index entries follow
+      auto on_move = [this, table_info](Row &row, const RowId &old_rid) {
+        std::vector<IndexInfo *> indexes;
+        catalog_mgr_->GetTableIndexes(table_info->GetTableName(), indexes);
+        for (auto index_info : indexes) {
+          Row key_row;
+          row.GetKeyFromRow(table_info->GetSchema(), index_info->GetIndexKeySchema(), key_row);
+          index_info->GetIndex()->RemoveEntry(key_row, old_rid, nullptr);
+          index_info->GetIndex()->InsertEntry(key_row, row.GetRowId(), nullptr);
+        }
+      };
+      tables.push_back({table_info->GetTableHeap(), on_move});
+    }
+  });
+}
+
+std::shared_lock<std::shared_mutex> DBStorageEngine::Foreground() {
+  return vacuum_worker_ == nullptr ? std::shared_lock<std::shared_mutex>() : vacuum_worker_->Foreground();
+}
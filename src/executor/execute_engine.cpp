@@ -6,6 +6,7 @@
 #include <sys/types.h>
 
 #include <chrono>
+#include <filesystem>
 
 #include "../../test/execution/executor_test_util.h"
 #include "common/result_writer.h"
@@ -120,6 +121,17 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
       return ExecuteShowDatabases(ast, context.get());
     case kNodeUseDB:
       return ExecuteUseDatabase(ast, context.get());
+    case kNodeExecFile:
+      return ExecuteExecfile(ast, context.get());
+    case kNodeQuit:
+      return ExecuteQuit(ast, context.get());
+    default:
+      break;
+  }
+  // the statements below work on the tables of the current database, its vacuum waits until they are done
+  std::shared_lock<std::shared_mutex> foreground;
+  if (!current_db_.empty()) foreground = dbs_[current_db_]->Foreground();
+  switch (ast->type_) {
     case kNodeShowTables:
       return ExecuteShowTables(ast, context.get());
     case kNodeCreateTable:
@@ -138,10 +150,6 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
       return ExecuteTrxCommit(ast, context.get());
     case kNodeTrxRollback:
       return ExecuteTrxRollback(ast, context.get());
-    case kNodeExecFile:
-      return ExecuteExecfile(ast, context.get());
-    case kNodeQuit:
-      return ExecuteQuit(ast, context.get());
     default:
       break;
   }
@@ -262,7 +270,11 @@ dberr_t ExecuteEngine::ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *cont
     return DB_NOT_EXIST;
   }
   remove(("./databases/" + db_name).c_str());
+  remove(CompressedPageStore::GetFileName("./databases/" + db_name).c_str());
+  std::string resident_pages_file = dbs_[db_name]->resident_pages_file_;
   delete dbs_[db_name];
+  remove(resident_pages_file.c_str());
+  std::filesystem::remove_all(DiskManager::GetSpaceDirectory("./databases/" + db_name));
   dbs_.erase(db_name);
   if (db_name == current_db_)
     current_db_ = "";
@@ -302,6 +314,7 @@ dberr_t ExecuteEngine::ExecuteUseDatabase(pSyntaxNode ast, ExecuteContext *conte
   string db_name = ast->child_->val_;
   if (dbs_.find(db_name) != dbs_.end()) {
     current_db_ = db_name;
+    dbs_[db_name]->StartVacuum();
     cout << "Database changed" << endl;
     return DB_SUCCESS;
   }
@@ -10,7 +10,6 @@ IndexScanExecutor::IndexScanExecutor(ExecuteContext *exec_ctx, const IndexScanPl
 
 void IndexScanExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
   result_ = IndexScan(plan_->GetPredicate());
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), plan_->OutputSchema());
 }
@@ -32,18 +31,6 @@ bool IndexScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *ou
   return true;
 }
 
-void IndexScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row,
-                                      Row *output_row) {
-  const auto &output_columns = output_schema->GetColumns();
-  std::vector<Field> dest_row;
-  dest_row.reserve(output_columns.size());
-  for (const auto column : output_columns) {
-    auto idx = column->GetTableInd();
-    dest_row.emplace_back(*row->GetField(idx));
-  }
-  *output_row = Row(dest_row);
-}
-
 vector<RowId> IndexScanExecutor::IndexScan(AbstractExpressionRef predicate) {
   switch (predicate->GetType()) {
     case ExpressionType::LogicExpression: {
@@ -78,24 +65,21 @@ vector<RowId> IndexScanExecutor::IndexScan(AbstractExpressionRef predicate) {
 
 bool IndexScanExecutor::Next(Row *row, RowId *rid) {
   auto predicate = plan_->GetPredicate();
-  auto table_schema = table_info_->GetSchema();
   while (cursor_ < result_.size()) {
-    auto p_row = new Row(result_[cursor_]);
-    table_info_->GetTableHeap()->GetTuple(p_row, nullptr);
-    if (plan_->need_filter_) {
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-        cursor_++;
-        continue;
-      }
+    bool found = table_info_->GetTableHeap()->GetTupleView(result_[cursor_], &view_, exec_ctx_->GetTransaction());
+    cursor_++;
+    if (!found || (plan_->need_filter_ && !predicate->Evaluate(view_).CompareEquals(Field(kTypeInt, 1)))) {
+      continue;
     }
-    *rid = result_[cursor_];
+    *rid = view_.GetRowId();
     if (!is_schema_same_) {
-      TupleTransfer(table_schema, plan_->OutputSchema(), p_row, row);
+      view_.ToRow(row, plan_->OutputSchema());
     } else {
-      *row = *p_row;
+      view_.ToRow(row);
     }
-    cursor_++;
+    view_.Release();
     return true;
   }
+  view_.Release();
   return false;
 }
@@ -26,45 +26,32 @@ bool SeqScanExecutor::SchemaEqual(const Schema *table_schema, const Schema *outp
   return true;
 }
 
-void SeqScanExecutor::TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row,
-                                    Row *output_row) {
-  const auto &output_columns = output_schema->GetColumns();
-  std::vector<Field> dest_row;
-  dest_row.reserve(output_columns.size());
-  for (const auto column : output_columns) {
-    auto idx = column->GetTableInd();
-    dest_row.emplace_back(*row->GetField(idx));
-  }
-  *output_row = Row(dest_row);
-}
-
 void SeqScanExecutor::Init() {
   exec_ctx_->GetCatalog()->GetTable(plan_->GetTableName(), table_info_);
-  auto first_row = table_info_->GetTableHeap()->Begin(nullptr);
-  iterator_ = (table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction()));
+  iterator_ = table_info_->GetTableHeap()->Begin(exec_ctx_->GetTransaction(), true);
   schema_ = plan_->OutputSchema();
   is_schema_same_ = SchemaEqual(table_info_->GetSchema(), schema_);
 }
 
 bool SeqScanExecutor::Next(Row *row, RowId *rid) {
   auto predicate = plan_->GetPredicate();
-  auto table_schema = table_info_->GetSchema();
-  while (iterator_ != table_info_->GetTableHeap()->End()) {
-    auto p_row = &(*iterator_);
-    if (predicate != nullptr) {
-      if (!predicate->Evaluate(p_row).CompareEquals(Field(kTypeInt, 1))) {
-        iterator_++;
-        continue;
-      }
+  auto table_end = table_info_->GetTableHeap()->End();
+  // rows are filtered in place, only the ones that pass are copied out
+  while (iterator_ != table_end) {
+    bool found = iterator_.GetView(&view_);
+    ++iterator_;
+    if (!found || (predicate != nullptr && !predicate->Evaluate(view_).CompareEquals(Field(kTypeInt, 1)))) {
+      continue;
     }
-    *rid = iterator_->GetRowId();
+    *rid = view_.GetRowId();
     if (!is_schema_same_) {
-      TupleTransfer(table_schema, schema_, p_row, row);
+      view_.ToRow(row, schema_);
     } else {
-      *row = *p_row;
+      view_.ToRow(row);
     }
-    iterator_++;
+    view_.Release();
     return true;
   }
+  view_.Release();
   return false;
 }
@@ -1,10 +1,19 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <string>
 #include <mutex>
-#include <unordered_map>
+#include <thread>
+#include <vector>
 
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
@@ -12,25 +21,218 @@
 
 using namespace std;
 
+/**
+ * A run of consecutive pages allocated ahead for one table heap or index, so that its pages are contiguous on disk
+ * even when several of them grow at the same time. Pages in [next_page_id_, end_page_id_) are allocated on disk but
+ * not in use yet.
+ */
+struct PageReservation {
+  mutex latch_;
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  page_id_t end_page_id_{INVALID_PAGE_ID};
+  space_id_t space_id_{0};  // tablespace the pages are allocated in
+};
+
+/**
+ * BufferPoolManager caches disk pages in a fixed number of frames.
+ *
+ * Fetching a resident page and unpinning it do not take latch_: the page is looked up in the lock-free page table and
+ * pinned with a CAS on its pin count. Frames that are free or being replaced hold a pin count of FRAME_LOCKED, which
+ * such a CAS never succeeds on. Everything else (misses, new pages, eviction, deletion) is serialized on latch_.
+ *
+ * Hits and unpins do not touch the replacer directly. Each thread queues them in a small batch per buffer pool, which
+ * is replayed into the replacer whenever the thread takes latch_ or the batch fills up. A frame whose unpin is still
+ * queued, or was lost with a thread that exited, is not in the replacer yet. When the replacer has no victim left, a
+ * miss scans the frames for such an unpinned one instead, so no frame is stranded.
+ *
+ * A background flusher thread writes cold dirty pages back ahead of eviction whenever more than the dirty ratio target
+ * of the frames is dirty, so that misses mostly replace clean pages without a synchronous write.
+ *
+ * Pages can be read ahead of use by a small pool of I/O threads, started on the first prefetch request. Prefetched
+ * pages are left unpinned in the pool and handed to the replacer. Runs of consecutive pages are read with one vectored
+ * read into frames that are registered in the page table but stay locked until the read is done; fetches of such a
+ * page wait for it. Flushing all pages likewise writes runs of consecutive dirty pages with one vectored write.
+ *
+ * With a resident pages file set, the ids of the resident pages are saved there on shutdown, hottest first, so that
+ * the next run can preload them with PreloadResidentPages.
+ *
+ * The pool can be resized while in use. Frames beyond the new size are flushed and dropped right away if unpinned,
+ * otherwise as soon as they are unpinned. Frame descriptors and data never move, so pinned pages stay valid.
+ */
 class BufferPoolManager {
+  friend class ParallelBufferPoolManager;
+
  public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  /**
+   * @param max_pool_size largest size the pool can be resized to, 0 to keep it at most pool_size. Address space for
+   * the frames and the frame descriptors is reserved for this many frames up front.
+   */
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
+                             ReplacerType replacer_type = DEFAULT_REPLACER_TYPE, size_t max_pool_size = 0);
+
+  virtual ~BufferPoolManager();
+
+  /**
+   * Fetch a page and pin it.
+   * @param bulk_read true if the page is read by a large sequential scan, on a miss it then replaces a frame of the
+   *                  bulk read ring rather than a frame from the shared pool
+   */
+  virtual Page *FetchPage(page_id_t page_id, bool bulk_read = false);
+
+  virtual bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+  virtual bool FlushPage(page_id_t page_id);
+
+  virtual Page *NewPage(page_id_t &page_id);
+
+  /**
+   * Create a new page from the run of reservation, reserving the next run of SEGMENT_RUN_PAGES pages once it is used
+   * up. Falls back to a single page anywhere in the tablespace of reservation if no run is free.
+   */
+  Page *NewPage(page_id_t &page_id, PageReservation *reservation);
+
+  /**
+   * Give the pages of reservation that are not in use back to the disk manager
+   */
+  void ReleasePages(PageReservation *reservation);
+
+  virtual bool DeletePage(page_id_t page_id);
+
+  /**
+   * Drop the resident pages in [first_page_id, last_page_id] without writing them back, waiting for pins that other
+   * threads hold only briefly, e.g. for writing a page back. The pages stay allocated on disk.
+   */
+  virtual void DiscardPages(page_id_t first_page_id, page_id_t last_page_id);
+
+  /**
+   * Discard the pages of a tablespace and remove its file
+   */
+  void DropSpace(space_id_t space_id);
+
+  /** @return the tablespace of a table, see DiskManager::GetTableSpace */
+  space_id_t GetTableSpace(table_id_t table_id) const { return disk_manager_->GetTableSpace(table_id); }
+
+  /** @return the tablespace of an index, see DiskManager::GetIndexSpace */
+  space_id_t GetIndexSpace(index_id_t index_id) const { return disk_manager_->GetIndexSpace(index_id); }
+
+  virtual bool IsPageFree(page_id_t page_id);
+
+  virtual bool CheckAllUnpinned();
+
+  /**
+   * Write every dirty page to disk, runs of consecutive pages with one vectored write each
+   */
+  void FlushAllPages();
+
+  /**
+   * Write every dirty page to disk, then the allocation state of the disk manager
+   */
+  void Checkpoint();
+
+  /**
+   * @return whether the page is currently held in a frame of the buffer pool, only a hint while other threads change
+   *         the pool
+   */
+  virtual bool IsPageResident(page_id_t page_id);
+
+  /**
+   * Set the fraction of frames that may stay dirty before the background flusher writes cold dirty pages back
+   */
+  virtual void SetDirtyRatioTarget(double dirty_ratio_target);
+
+  /**
+   * @return the number of dirty pages in the buffer pool, a page being written back counts until its write is done
+   */
+  virtual size_t DirtyPageCount();
+
+  /**
+   * Read pages into the buffer pool in the background, pages that are already resident are skipped
+   */
+  virtual void PrefetchPages(const vector<page_id_t> &page_ids, bool bulk_read = false);
+
+  /**
+   * Grow or shrink the buffer pool to pool_size frames
+   * @return false if pool_size is 0 or larger than the max_pool_size the pool was created with
+   */
+  virtual bool Resize(size_t pool_size);
 
-  ~BufferPoolManager();
+  /**
+   * @return the number of frames of the buffer pool
+   */
+  virtual size_t GetPoolSize();
 
-  Page *FetchPage(page_id_t page_id, bool flag = false);
+  /**
+   * @return the page size of the database the pool serves, the size of every frame
+   */
+  uint32_t GetPageSize() { return disk_manager_->GetPageSize(); }
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  /**
+   * Save the ids of the resident pages to file_name when the buffer pool is destroyed
+   */
+  void SetResidentPagesFile(const string &file_name) { resident_pages_file_ = file_name; }
 
-  bool FlushPage(page_id_t page_id);
+  /**
+   * Read the pages saved to file_name by an earlier buffer pool into this one in the background, the hottest ones that
+   * fit in page id order, then remove the file
+   * @return the number of pages being preloaded
+   */
+  size_t PreloadResidentPages(const string &file_name);
 
-  Page *NewPage(page_id_t &page_id);
+ protected:
+  /**
+   * Create a buffer pool without frames of its own, for pools that delegate to other instances
+   */
+  explicit BufferPoolManager(DiskManager *disk_manager);
+
+  /**
+   * Stop the prefetch I/O threads, dropping requests that have not started yet
+   */
+  void StopPrefetchThreads();
+
+  /**
+   * Take every page out of the replacer, only used on shutdown
+   * @return the ids of the resident pages, hottest first
+   */
+  virtual vector<page_id_t> DrainResidentPages();
+
+  /**
+   * Write the resident pages to the resident pages file, if one is set
+   */
+  void SaveResidentPages();
+
+  /**
+   * @return the buffer pool instance that holds page_id
+   */
+  virtual BufferPoolManager *GetInstance(__attribute__((unused)) page_id_t page_id) { return this; }
+
+  /**
+   * Pin every dirty page of the pool for writing it back
+   */
+  virtual void PinDirtyPages(vector<Page *> *pages);
+
+  /**
+   * Write back pages pinned by PinDirtyPages in page id order and unpin them. Runs of consecutive pages are written
+   * with one vectored write, single pages asynchronously, all of them in flight at once.
+   */
+  void WriteBackPages(vector<Page *> &pages);
 
-  bool DeletePage(page_id_t page_id);
+  /**
+   * Read count consecutive pages starting at first_page_id into the pool unpinned, those that are not resident yet
+   * with one vectored read
+   */
+  void PrefetchRun(page_id_t first_page_id, size_t count, bool bulk_read);
 
-  bool IsPageFree(page_id_t page_id);
+  /**
+   * Take a frame for reading page_id in and register it in the page table. The frame stays locked until
+   * PublishFrame, fetches of the page wait for it meanwhile.
+   * @return nullptr if page_id is resident already or all frames are pinned
+   */
+  Page *ReserveFrame(page_id_t page_id, bool bulk_read);
 
-  bool CheckAllUnpinned();
+  /**
+   * Make a frame reserved by ReserveFrame usable, unpinned, once its page has been read in
+   */
+  void PublishFrame(Page *page);
 
  private:
   /**
@@ -43,16 +245,165 @@ class BufferPoolManager {
    */
   void DeallocatePage(page_id_t page_id);
 
+  /**
+   * Bring a page that is already allocated on disk into a zeroed frame and pin it
+   * @return nullptr if all frames are pinned
+   */
+  Page *NewPageWithId(page_id_t page_id);
+
+  /**
+   * Pin frame_id for page_id with zeroed memory and register it in the page table
+   */
+  Page *InitNewPage(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Find a frame for a new page from the free list or the replacer, the evicted page is written back if dirty
+   * @return INVALID_FRAME_ID if all frames are pinned
+   */
   frame_id_t TryToFindFreePage();
 
- private:
-  size_t pool_size_;                                 // number of pages in buffer pool
-  Page *pages_;                                      // array of pages
+  /**
+   * Evict an unpinned frame the replacer does not know of yet, scanning on from where the last scan stopped
+   * @return INVALID_FRAME_ID if all frames are pinned
+   */
+  frame_id_t TryToFindUnpinnedFrame();
+
+  /**
+   * Find a frame for page_id in the bulk read ring, recycling the ring's own frames once it is full
+   */
+  frame_id_t TryToFindRingPage(page_id_t page_id);
+
+  /**
+   * Read page_id from disk into a frame and register it in the page table, the frame is left locked
+   * @return INVALID_FRAME_ID if all frames are pinned
+   */
+  frame_id_t ReadInPage(page_id_t page_id, bool bulk_read);
+
+  /**
+   * Write back the page held in frame_id if dirty and drop it from the page table
+   */
+  void EvictPage(frame_id_t frame_id);
+
+  /**
+   * Set up the descriptors of frames up to num_frames and put the new frames on the free list
+   */
+  void AddFrames(size_t num_frames);
+
+  /**
+   * Drop the page of a locked frame from the page table without writing it back and free the frame
+   */
+  void DropFrame(frame_id_t frame_id);
+
+  /**
+   * Take a locked frame beyond the pool size out of use and release its memory
+   */
+  void RetireFrame(frame_id_t frame_id);
+
+  /**
+   * Size the bulk read ring for the current pool size, forgetting the frames it recycled so far
+   */
+  void ResetRing();
+
+  /**
+   * Pin frame_id without the latch if it is in use and still holds page_id
+   */
+  bool TryPinFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Drop one pin of frame_id without the latch
+   * @return false if the frame was not pinned
+   */
+  bool UnpinFrame(frame_id_t frame_id, bool is_dirty);
+
+  /**
+   * Take an unpinned frame out of use so that lock-free fetches cannot pin it, the caller holds latch_
+   * @return false if the frame is pinned
+   */
+  bool LockFrame(frame_id_t frame_id);
+
+  /**
+   * Queue a lock-free pin or unpin of page_id in frame_id for the replacer
+   */
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id, bool unpin);
+
+  /**
+   * Replay the accesses queued by the calling thread into the replacer, the caller holds latch_
+   */
+  void ApplyAccesses();
+
+  /**
+   * Set the dirty flag of frame_id and put the frame on the dirty list if it was clean
+   */
+  void MarkDirty(frame_id_t frame_id);
+
+  /**
+   * Clear the dirty flag of frame_id
+   */
+  void MarkClean(frame_id_t frame_id);
+
+  /** @return the frame described by page */
+  inline frame_id_t GetFrameId(Page *page) const { return static_cast<frame_id_t>(page - pages_); }
+
+  /**
+   * Body of the background flusher thread
+   */
+  void FlusherLoop();
+
+  /**
+   * Write back the longest dirty unpinned pages until the dirty ratio target is met, in page id order
+   */
+  void FlushDirtyPages();
+
+  /**
+   * Body of the prefetch I/O threads
+   */
+  void PrefetchLoop();
+
+  /**
+   * A run of count consecutive pages to read ahead starting at page_id
+   */
+  struct PrefetchRequest {
+    page_id_t page_id;
+    size_t count;
+    bool bulk_read;
+  };
+
+  /**
+   * Queue a prefetch request, starting the I/O threads if needed
+   */
+  void SubmitPrefetch(PrefetchRequest request);
+
+ protected:
   DiskManager *disk_manager_;                        // pointer to the disk manager.
-  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
+
+ private:
+  atomic<size_t> pool_size_;                         // number of pages in buffer pool
+  size_t num_frames_{0};                             // number of frame descriptors, frames beyond pool_size_ retire
+  Page *pages_;                                      // array of frame descriptors
+  FrameArena arena_;                                 // data of the frames, apart from the descriptors
+  PageTable page_table_;                             // to keep track of pages
   Replacer *replacer_;                               // to find an unpinned page for replacement
   list<frame_id_t> free_list_;                       // to find a free page for replacement
   recursive_mutex latch_;                            // to protect shared data structure
+  vector<frame_id_t> ring_frames_;                   // frames recycled by bulk reads
+  vector<page_id_t> ring_pages_;                     // page each ring frame was last filled with
+  size_t ring_pos_{0};                               // next ring slot to recycle
+  size_t scan_pos_{0};                               // next frame TryToFindUnpinnedFrame looks at
+  uint64_t instance_id_;                             // key of this pool in the per-thread access batches
+  atomic<size_t> num_dirty_{0};                      // number of dirty frames
+  vector<frame_id_t> dirty_frames_;                  // frames in the order they became dirty, may hold stale entries
+  mutex dirty_latch_;                                // protects dirty_frames_
+  atomic<double> dirty_ratio_target_{DEFAULT_DIRTY_RATIO_TARGET};  // fraction of frames allowed to stay dirty
+  thread flusher_;                                   // background flusher writing dirty pages ahead of eviction
+  mutex flusher_latch_;                              // protects stop_flusher_
+  condition_variable flusher_cv_;                    // wakes the flusher early or for shutdown
+  bool stop_flusher_{false};                         // set to stop the flusher
+  vector<thread> io_threads_;                        // threads serving prefetch requests
+  deque<PrefetchRequest> prefetch_queue_;            // prefetch requests not started yet
+  mutex prefetch_latch_;                             // protects io_threads_, prefetch_queue_ and stop_prefetch_
+  condition_variable prefetch_cv_;                   // wakes the I/O threads
+  bool stop_prefetch_{false};                        // set to stop the I/O threads
+  string resident_pages_file_;                       // where to save the resident pages on shutdown
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -1,5 +1,5 @@
-#ifndef MINISQL_LRU_REPLACER_H
-#define MINISQL_LRU_REPLACER_H
+#ifndef MINISQL_CLOCK_REPLACER_H
+#define MINISQL_CLOCK_REPLACER_H
 
 #include <vector>
 #include <mutex>
@@ -30,6 +30,8 @@ public:
 
   void Unpin(frame_id_t frame_id) override;
 
+  void Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
   size_t TotalSize() override;
@@ -41,4 +43,4 @@ private:
   size_t hand_; // Current position of the clock hand
 };
 
-#endif  // MINISQL_LRU_REPLACER_H
+#endif  // MINISQL_CLOCK_REPLACER_H
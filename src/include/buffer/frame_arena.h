@@ -0,0 +1,48 @@
+#ifndef MINISQL_FRAME_ARENA_H
+#define MINISQL_FRAME_ARENA_H
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * FrameArena holds the data of all frames of a buffer pool in one contiguous, page aligned mapping, so that frame
+ * buffers can be handed to direct I/O and the frame descriptors (Page) stay apart from the page data. A frame is as
+ * large as a page of the database the buffer pool serves.
+ *
+ * The address range for max_frames frames is reserved up front without backing memory, and Grow makes frames usable
+ * as the buffer pool grows. Frame addresses therefore never change when the pool is resized. With huge pages
+ * requested the committed range is marked for transparent huge pages.
+ */
+class FrameArena {
+ public:
+  explicit FrameArena(size_t max_frames, size_t frame_size = DEFAULT_PAGE_SIZE, bool huge_pages = USE_HUGE_PAGES);
+
+  ~FrameArena();
+
+  DISALLOW_COPY(FrameArena);
+
+  /**
+   * Make frames [0, num_frames) usable, frames that were usable already keep their data
+   */
+  void Grow(size_t num_frames);
+
+  /**
+   * Give the memory of frame_id back to the system, the frame reads as zeros afterwards
+   */
+  void Discard(frame_id_t frame_id);
+
+  /** @return the frame_size bytes of frame_id */
+  inline char *FrameData(frame_id_t frame_id) { return data_ + static_cast<size_t>(frame_id) * frame_size_; }
+
+  /** @return the number of frames the arena can grow to */
+  inline size_t MaxFrames() const { return max_frames_; }
+
+ private:
+  char *data_{nullptr};   // start of the reserved range
+  size_t max_frames_;     // number of frames the range is reserved for
+  size_t frame_size_;     // bytes of a frame
+  size_t num_frames_{0};  // number of usable frames
+  bool huge_pages_;       // whether to ask for transparent huge pages
+};
+
+#endif  // MINISQL_FRAME_ARENA_H
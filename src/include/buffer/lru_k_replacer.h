@@ -0,0 +1,77 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the frame whose k-th most recent access is the oldest. Frames referenced fewer than k times have an
+ * infinite backward k-distance and are evicted first, oldest first access first, so pages touched once by a
+ * sequential scan never push out pages that are referenced repeatedly (e.g. B+ tree internal pages).
+ *
+ * Every Pin counts as an access. Back-to-back accesses to the same frame with no other frame accessed in between
+ * are treated as one correlated reference, so fetching the same page once per tuple does not make it look hot.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses to track for each frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRU_K_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  size_t TotalSize() override;
+
+ private:
+  using EvictionKey = pair<uint64_t, frame_id_t>;
+
+  /**
+   * Make sure the per-frame arrays can hold frame_id.
+   */
+  void Reserve(frame_id_t frame_id);
+
+  /**
+   * Append an access at the current timestamp to the history of frame_id.
+   */
+  void RecordAccess(frame_id_t frame_id);
+
+  /**
+   * @return the set frame_id belongs to while it is evictable, together with its ordering key
+   */
+  set<EvictionKey> &EvictableSet(frame_id_t frame_id, EvictionKey *key);
+
+ private:
+  size_t k_;                                    // number of accesses tracked per frame
+  uint64_t current_timestamp_{0};               // logical clock, advanced on every access
+  frame_id_t last_accessed_{INVALID_FRAME_ID};  // frame of the latest access, for correlated references
+  vector<vector<uint64_t>> history_;            // at most k latest access timestamps of each frame, oldest first
+  vector<bool> evictable_;                      // whether a frame is currently victimizable
+  set<EvictionKey> cold_;                       // evictable frames with fewer than k accesses, by first access
+  set<EvictionKey> hot_;                        // evictable frames with k accesses, by k-th most recent access
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
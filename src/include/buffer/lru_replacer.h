@@ -13,6 +13,9 @@ using namespace std;
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * Unpinned frames are kept in an intrusive doubly-linked list whose links are stored in arrays indexed by frame id,
+ * so Pin, Unpin and Victim are all O(1) regardless of the pool size.
  */
 class LRUReplacer : public Replacer {
  public:
@@ -33,14 +36,35 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
   size_t TotalSize() override;
 
-private:
-  // add your own private member variables here
-  list <frame_id_t> replaceList;
-  list <frame_id_t> irreplaceList;
+ private:
+  /**
+   * Make sure the link arrays can hold frame_id.
+   */
+  void Reserve(frame_id_t frame_id);
+
+  /**
+   * Append frame_id to the most recently used end of the list.
+   */
+  void PushBack(frame_id_t frame_id);
+
+  /**
+   * Unlink frame_id from the list.
+   */
+  void Unlink(frame_id_t frame_id);
+
+ private:
+  vector<frame_id_t> prev_;            // previous (less recently used) frame of each frame in the list
+  vector<frame_id_t> next_;            // next (more recently used) frame of each frame in the list
+  vector<bool> in_list_;               // whether a frame is currently victimizable
+  frame_id_t head_{INVALID_FRAME_ID};  // least recently unpinned frame
+  frame_id_t tail_{INVALID_FRAME_ID};  // most recently unpinned frame
+  size_t size_{0};                     // number of victimizable frames
 };
 
 #endif  // MINISQL_LRU_REPLACER_H
@@ -0,0 +1,87 @@
+#ifndef MINISQL_PAGE_TABLE_H
+#define MINISQL_PAGE_TABLE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * PageTable maps the page ids held by a buffer pool to their frames. It is an open-addressing hash table with linear
+ * probing and a capacity of at least twice the number of frames. A slot packs a page id of PAGE_ID_BITS bits and a
+ * frame id into one 64-bit word, so that it is read and written atomically.
+ *
+ * Find never blocks and may run concurrently with one writer. Insert, Erase and Reserve must be serialized by the
+ * caller (the buffer pool latch). Erase shifts later entries of the probe chain backwards, so a concurrent Find can
+ * miss an entry that is being moved; callers treat a miss as a hint and retry under the latch. Reserve moves the
+ * entries to a larger table and keeps the old one alive for readers still probing it, which may then return a stale
+ * frame; callers validate the frame after pinning it.
+ */
+class PageTable {
+ public:
+  explicit PageTable(size_t num_frames);
+
+  ~PageTable() = default;
+
+  /**
+   * @param[out] frame_id frame holding page_id
+   * @return true if page_id was found
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Map page_id to frame_id, replacing the previous mapping of page_id if any.
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @return true if page_id was present
+   */
+  bool Erase(page_id_t page_id);
+
+  /** @return the number of pages in the table */
+  size_t Size() const { return size_; }
+
+  /**
+   * Grow the table so that it can hold the pages of num_frames frames
+   */
+  void Reserve(size_t num_frames);
+
+ private:
+  static constexpr uint64_t EMPTY_SLOT = UINT64_MAX;
+  static constexpr int FRAME_ID_BITS = 64 - PAGE_ID_BITS;
+  static_assert(MAX_BUFFER_POOL_SIZE < (1 << FRAME_ID_BITS), "Frame ids do not fit a slot.");
+
+  struct Slots {
+    explicit Slots(size_t num_frames);
+
+    size_t mask_;                                     // capacity - 1, capacity is a power of two
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;  // page id (high bits) and frame id (low FRAME_ID_BITS bits)
+  };
+
+  static uint64_t MakeSlot(page_id_t page_id, frame_id_t frame_id) {
+    return static_cast<uint64_t>(page_id) << FRAME_ID_BITS | static_cast<uint32_t>(frame_id);
+  }
+
+  static page_id_t SlotPageId(uint64_t slot) { return static_cast<page_id_t>(slot >> FRAME_ID_BITS); }
+
+  static frame_id_t SlotFrameId(uint64_t slot) {
+    return static_cast<frame_id_t>(slot & ((uint64_t{1} << FRAME_ID_BITS) - 1));
+  }
+
+  /** @return the home slot of page_id */
+  static size_t Home(page_id_t page_id, size_t mask) {
+    return static_cast<size_t>((static_cast<uint64_t>(page_id) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+  }
+
+  /** Insert into slots, the caller knows that page_id is not present */
+  static void InsertInto(Slots *table, uint64_t slot);
+
+ private:
+  std::atomic<Slots *> current_;                // table probed by readers
+  std::vector<std::unique_ptr<Slots>> tables_;  // current table and the ones it replaced
+  size_t size_{0};                              // number of pages, only touched by the writer
+};
+
+#endif  // MINISQL_PAGE_TABLE_H
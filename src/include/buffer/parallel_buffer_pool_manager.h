@@ -0,0 +1,81 @@
+#ifndef MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+#define MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * ParallelBufferPoolManager shards pages across several independent BufferPoolManager instances by
+ * page_id % num_instances. Every instance has its own latch, free list and replacer, so threads working on pages of
+ * different instances never contend with each other.
+ *
+ * NewPage goes round-robin over the instances, taking the lowest free page id routed to the instance from the disk
+ * manager. An instance whose frames are all pinned is skipped.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @param num_instances number of buffer pool instances
+   * @param pool_size number of frames of each instance
+   * @param max_pool_size largest size each instance can be resized to, 0 to keep it at most pool_size
+   */
+  explicit ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                     ReplacerType replacer_type = DEFAULT_REPLACER_TYPE, size_t max_pool_size = 0);
+
+  ~ParallelBufferPoolManager() override;
+
+  Page *FetchPage(page_id_t page_id, bool bulk_read = false) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  Page *NewPage(page_id_t &page_id) override;
+
+  using BufferPoolManager::NewPage;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  void DiscardPages(page_id_t first_page_id, page_id_t last_page_id) override;
+
+  bool IsPageFree(page_id_t page_id) override;
+
+  bool CheckAllUnpinned() override;
+
+  bool IsPageResident(page_id_t page_id) override;
+
+  void SetDirtyRatioTarget(double dirty_ratio_target) override;
+
+  size_t DirtyPageCount() override;
+
+  /**
+   * Resize every instance to an equal share of pool_size frames
+   */
+  bool Resize(size_t pool_size) override;
+
+  size_t GetPoolSize() override;
+
+ protected:
+  /**
+   * Interleave the resident pages of the instances by their rank in each instance
+   */
+  vector<page_id_t> DrainResidentPages() override;
+
+  /**
+   * @return the instance responsible for page_id
+   */
+  BufferPoolManager *GetInstance(page_id_t page_id) override;
+
+  /**
+   * Pin the dirty pages of all instances, so that consecutive pages of different instances are written together
+   */
+  void PinDirtyPages(vector<Page *> *pages) override;
+
+ private:
+  vector<BufferPoolManager *> instances_;  // buffer pool instances, indexed by page_id % num_instances
+  atomic<size_t> next_instance_{0};        // instance the next NewPage starts at
+};
+
+#endif  // MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
@@ -29,7 +29,9 @@ class TableMetadata {
 
   inline std::string GetTableName() const { return table_name_; }
 
-  inline uint32_t GetFirstPageId() const { return root_page_id_; }
+  inline page_id_t GetFirstPageId() const { return root_page_id_; }
+
+  inline void SetFirstPageId(page_id_t first_page_id) { root_page_id_ = first_page_id; }
 
   inline Schema *GetSchema() const { return schema_; }
 
@@ -1,32 +1,77 @@
 #ifndef MINISQL_CONFIG_H
 #define MINISQL_CONFIG_H
 
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 
-static constexpr int INVALID_PAGE_ID = -1;   // invalid page id
-static constexpr int INVALID_FRAME_ID = -1;  // invalid recovery id
-static constexpr int INVALID_TXN_ID = -1;    // invalid recovery id
-static constexpr int INVALID_LSN = -1;       // invalid log sequence number
+using page_id_t = int64_t;
+
+static constexpr page_id_t INVALID_PAGE_ID = -1;  // invalid page id
+static constexpr int INVALID_FRAME_ID = -1;       // invalid recovery id
+static constexpr int INVALID_TXN_ID = -1;         // invalid recovery id
+static constexpr int INVALID_LSN = -1;            // invalid log sequence number
 
 static constexpr int META_PAGE_ID = 0;          // physical page id of the disk file meta info
 static constexpr int CATALOG_META_PAGE_ID = 0;  // logical page id of the catalog meta data
 static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index roots
 
-static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
+static constexpr int MIN_PAGE_SIZE = 4096;              // smallest page size a database can be created with
+static constexpr int MAX_PAGE_SIZE = 32768;             // largest page size a database can be created with
+static constexpr int DEFAULT_PAGE_SIZE = 4096;          // page size of a new database unless it asks for another
+
+/**
+ * @return whether a database can be created with pages of page_size bytes, a power of two within the bounds
+ */
+static constexpr bool IsValidPageSize(uint32_t page_size) {
+  return page_size >= MIN_PAGE_SIZE && page_size <= MAX_PAGE_SIZE && (page_size & (page_size - 1)) == 0;
+}
+
+static_assert(IsValidPageSize(DEFAULT_PAGE_SIZE), "Unsupported page size.");
+
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int MAX_BUFFER_POOL_SIZE = 1 << 20;    // largest size a buffer pool can be given
+static constexpr int BULK_READ_RING_SIZE = 32;          // number of frames a sequential scan may recycle
+static constexpr int ACCESS_BATCH_SIZE = 64;            // lock-free page accesses a thread queues for the replacer
+static constexpr double DEFAULT_DIRTY_RATIO_TARGET = 0.25;  // fraction of frames the flusher lets stay dirty
+static constexpr int FLUSHER_INTERVAL_MS = 50;              // period of the background flusher
+static constexpr int PREFETCH_IO_THREADS = 2;               // I/O threads serving read-ahead of a buffer pool
+static constexpr int PREFETCH_RUN_PAGES = 64;               // consecutive pages a prefetch reads with one vectored read
+static constexpr bool USE_HUGE_PAGES = true;                // back the frames of a buffer pool with huge pages
+static constexpr int IO_URING_QUEUE_DEPTH = 128;            // page I/Os the disk manager keeps in flight with io_uring
+static constexpr int SEGMENT_RUN_PAGES = 64;                // contiguous pages a table heap or index reserves at once
+static constexpr int FILE_GROW_PAGES = 1024;                // pages the db file is preallocated by when it grows
+static constexpr bool PUNCH_FREED_PAGES = true;             // give the disk space of de-allocated pages back
+static constexpr int VACUUM_INTERVAL_MS = 100;              // period of the background vacuum
+static constexpr int VACUUM_PAGES_PER_ROUND = 16;           // table pages the vacuum visits per period at most
+static constexpr double VACUUM_DEAD_RATIO = 0.2;            // share of deleted tuples a page is compacted from
+static constexpr double VACUUM_MERGE_RATIO = 0.5;           // share of used space up to which a page is merged into its prev
+
+enum class ReplacerType { LRU_REPLACER = 0, CLOCK_REPLACER, LRU_K_REPLACER };
+
+static constexpr ReplacerType DEFAULT_REPLACER_TYPE = ReplacerType::LRU_K_REPLACER;  // replacement policy of buffer pool
+static constexpr size_t LRU_K_REPLACER_K = 2;  // number of accesses tracked by the LRU-K replacer
+
+enum class DiskIOType { FSTREAM_IO = 0, PREAD_IO, IO_URING };
+
+static constexpr DiskIOType DEFAULT_DISK_IO_TYPE = DiskIOType::PREAD_IO;  // how the disk manager accesses the db file
+static constexpr bool DEFAULT_COMPRESS_PAGES = false;  // whether new db files store their data pages compressed
+static constexpr bool DEFAULT_FILE_PER_TABLE = false;  // whether new db files keep every table and index in a file
+static constexpr int PAGE_ID_BITS = 40;                 // bits a valid page id fits in, 4PB of 4K pages
+static constexpr int TABLESPACE_ID_BITS = 8;            // high bits of a page id naming its tablespace
+static constexpr int TABLESPACE_PAGE_BITS = PAGE_ID_BITS - TABLESPACE_ID_BITS;  // low bits, the page within its space
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
-static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
+static constexpr uint32_t VARCHAR_MAX_LEN = MIN_PAGE_SIZE / 2;  // max length of varchar, fits a page of any size
 
 // static std::string DB_META_FILE = "minisql.meta.db";
 
-using page_id_t = int32_t;
 using frame_id_t = int32_t;
 using txn_id_t = int32_t;
 using lsn_t = int32_t;
 using column_id_t = uint32_t;
 using index_id_t = uint32_t;
 using table_id_t = uint32_t;
+using space_id_t = uint32_t;
 
 #endif  // MINISQL_CONFIG_H
@@ -2,6 +2,7 @@
 #define MINISQL_INSTANCE_H
 
 #include <memory>
+#include <shared_mutex>
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
@@ -11,21 +12,54 @@
 #include "common/macros.h"
 #include "executor/execute_context.h"
 #include "storage/disk_manager.h"
+#include "storage/vacuum_worker.h"
 
 class DBStorageEngine {
  public:
-  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE);
+  /**
+   * @param file_per_table keep every table and index of a new database in a tablespace file of its own
+   * @param max_buffer_pool_size largest size ResizeBufferPool can grow the buffer pool to, 0 for buffer_pool_size
+   * @param page_size page size of a new database, an existing database keeps the size it was created with
+   */
+  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE,
+                           bool file_per_table = DEFAULT_FILE_PER_TABLE, uint32_t max_buffer_pool_size = 0,
+                           uint32_t page_size = DEFAULT_PAGE_SIZE);
 
   ~DBStorageEngine();
 
   std::unique_ptr<ExecuteContext> MakeExecuteContext(Txn *txn);
 
+  /**
+   * Grow or shrink the buffer pool of this database while it is open
+   */
+  bool ResizeBufferPool(size_t buffer_pool_size);
+
+  /**
+   * Move the live pages of the database toward the front of its files and truncate them, see StorageCompactor. The
+   * catalog is reopened, so table and index infos taken from it before are invalid afterwards.
+   * @return DB_FAILED if a page is still pinned
+   */
+  dberr_t Compact();
+
+  /**
+   * Start the background vacuum of the tables of this database, see VacuumWorker. Tuples it moves get their index
+   * entries updated. From then on, work on the tables has to hold Foreground.
+   */
+  void StartVacuum();
+
+  /**
+   * Keep the background vacuum out while the lock is held, an empty lock if it is not started
+   */
+  std::shared_lock<std::shared_mutex> Foreground();
+
  public:
   DiskManager *disk_mgr_;
   BufferPoolManager *bpm_;
   CatalogManager *catalog_mgr_;
   std::string db_file_name_;
+  std::string resident_pages_file_;  // pages resident at the last clean shutdown, preloaded on open
   bool init_;
+  VacuumWorker *vacuum_worker_{nullptr};
 };
 
 #endif  // MINISQL_INSTANCE_H
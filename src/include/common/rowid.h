@@ -7,33 +7,41 @@
 #include "common/config.h"
 
 /**
- * | page_id(32bit) | slot_num(32bit) |
+ * | page_id(48bit) | slot_num(16bit) |
+ *
+ * A row id packs into a single 64-bit value, which is what the B+ tree leaves store, so 64-bit page ids do not widen
+ * the index entries. Page ids are below 1 << PAGE_ID_BITS and a page has far fewer than 1 << 16 slots.
  */
 class RowId {
  public:
   RowId() = default;
 
-  RowId(page_id_t page_id, uint32_t slot_num) : page_id_(page_id), slot_num_(slot_num) {}
+  RowId(page_id_t page_id, uint32_t slot_num) { Set(page_id, slot_num); }
 
-  explicit RowId(int64_t rid) : page_id_(static_cast<page_id_t>(rid >> 32)), slot_num_(static_cast<uint32_t>(rid)) {}
+  explicit RowId(int64_t rid) : rid_(rid) {}
 
-  inline int64_t Get() const { return (static_cast<int64_t>(page_id_)) << 32 | slot_num_; }
+  inline int64_t Get() const { return rid_; }
 
-  inline page_id_t GetPageId() const { return page_id_; }
+  inline page_id_t GetPageId() const { return rid_ >> SLOT_BITS; }
 
-  inline uint32_t GetSlotNum() const { return slot_num_; }
+  inline uint32_t GetSlotNum() const { return static_cast<uint32_t>(rid_ & (MAX_SLOTS - 1)); }
 
   inline void Set(page_id_t page_id, uint32_t slot_num) {
-    page_id_ = page_id;
-    slot_num_ = slot_num;
+    rid_ = static_cast<int64_t>(static_cast<uint64_t>(page_id) << SLOT_BITS | (slot_num & (MAX_SLOTS - 1)));
   }
 
-  bool operator==(const RowId &other) const { return page_id_ == other.page_id_ && slot_num_ == other.slot_num_; }
+  bool operator==(const RowId &other) const { return rid_ == other.rid_; }
+
+  static constexpr int SLOT_BITS = 16;
+  static constexpr uint32_t MAX_SLOTS = 1U << SLOT_BITS;
+
  private:
-  page_id_t page_id_{INVALID_PAGE_ID};
-  uint32_t slot_num_{0};  // logical offset of the record in page, starts from 0. eg:0, 1, 2...
+  // logical offset of the record in page in the low bits, starts from 0. eg:0, 1, 2...
+  int64_t rid_{static_cast<int64_t>(static_cast<uint64_t>(INVALID_PAGE_ID) << SLOT_BITS)};
 };
 
+static_assert(sizeof(RowId) == sizeof(int64_t));
+
 namespace std {
 template <>
 struct hash<RowId> {
@@ -36,8 +36,6 @@ class IndexScanExecutor : public AbstractExecutor {
 
   bool SchemaEqual(const Schema *table_schema, const Schema *output_schema);
 
-  void TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row, Row *output_row);
-
  private:
   vector<RowId> IndexScan(AbstractExpressionRef predicate);
 
@@ -46,5 +44,6 @@ class IndexScanExecutor : public AbstractExecutor {
   TableInfo *table_info_{};
   vector<RowId> result_;
   size_t cursor_ = 0;
+  TupleView view_;  // the row at cursor_, read in place
   bool is_schema_same_;
 };
\ No newline at end of file
@@ -39,13 +39,12 @@ class SeqScanExecutor : public AbstractExecutor {
 
   bool SchemaEqual(const Schema *table_schema, const Schema *output_schema);
 
-  void TupleTransfer(const Schema *table_schema, const Schema *output_schema, const Row *row, Row *output_row);
-
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableInfo *table_info_{};
   TableIterator iterator_;
+  TupleView view_;  // the row under the iterator, read in place
   const Schema *schema_{};
   bool is_schema_same_;
 };
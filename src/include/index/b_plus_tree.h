@@ -29,6 +29,8 @@ class BPlusTree {
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
                      int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
 
+  ~BPlusTree();
+
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
@@ -110,6 +112,7 @@ class BPlusTree {
   KeyManager processor_;
   int leaf_max_size_;
   int internal_max_size_;
+  PageReservation reservation_;  // run of pages new nodes of the tree are taken from
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
@@ -8,7 +8,7 @@
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define INTERNAL_PAGE_HEADER_SIZE 28
+#define INTERNAL_PAGE_HEADER_SIZE 40
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -70,8 +70,11 @@ class BPlusTreeInternalPage : public BPlusTreePage {
 
   void CopyFirstFrom(page_id_t value, BufferPoolManager *buffer_pool_manager);
 
-  char data_[PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE];
+  // the pairs fill the rest of the frame, whose size is the page size of the database
+  char data_[0];
 };
 
+static_assert(sizeof(BPlusTreeInternalPage) == INTERNAL_PAGE_HEADER_SIZE);
+
 using InternalPage = BPlusTreeInternalPage;
 #endif  // MINISQL_B_PLUS_TREE_INTERNAL_PAGE_H
@@ -13,13 +13,10 @@
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 48 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | BPlusTreePage header (40) | NextPageId (8) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
  */
 #include <utility>
 #include <vector>
@@ -27,7 +24,7 @@
 #include "index/generic_key.h"
 #include "page/b_plus_tree_page.h"
 
-#define LEAF_PAGE_HEADER_SIZE 32
+#define LEAF_PAGE_HEADER_SIZE 48
 
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
@@ -82,8 +79,11 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
   page_id_t next_page_id_{INVALID_PAGE_ID};
 
-  char data_[PAGE_SIZE - LEAF_PAGE_HEADER_SIZE];
+  // the pairs fill the rest of the frame, whose size is the page size of the database
+  char data_[0];
 };
 
+static_assert(sizeof(BPlusTreeLeafPage) == LEAF_PAGE_HEADER_SIZE);
+
 using LeafPage = BPlusTreeLeafPage;
 #endif  // MINISQL_B_PLUS_TREE_LEAF_PAGE_H
@@ -18,11 +18,11 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 28 bytes in total):
+ * Header format (size in byte, 40 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | KeySize (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | Padding (4) | ParentPageId (8) | PageId(8) |
  * ----------------------------------------------------------------------------
  */
 class BPlusTreePage {
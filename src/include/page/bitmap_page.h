@@ -6,6 +6,9 @@
 #include "common/config.h"
 #include "common/macros.h"
 
+/**
+ * The bitmap is searched a 64-bit word at a time: bit k of word w, loaded little endian, records page 64 * w + k.
+ */
 template <size_t PageSize>
 class BitmapPage {
  public:
@@ -14,6 +17,11 @@ class BitmapPage {
    */
   static constexpr size_t GetMaxSupportedSize() { return 8 * MAX_CHARS; }
 
+  /**
+   * @return The number of 64-bit words of the bitmap.
+   */
+  static constexpr size_t GetWordCount() { return MAX_CHARS / sizeof(uint64_t); }
+
   /**
    * @param page_offset Index in extent of the page allocated.
    * @return true if successfully allocate a page.
@@ -30,6 +38,30 @@ class BitmapPage {
    */
   bool IsPageFree(uint32_t page_offset) const;
 
+  /**
+   * @return whether one of the 64 pages recorded by a word of the bitmap is free
+   */
+  bool HasFreePage(uint32_t word_index) const { return GetWord(word_index) != ~uint64_t{0}; }
+
+  /**
+   * @return whether all of the 64 pages recorded by a word of the bitmap are free
+   */
+  bool IsWordFree(uint32_t word_index) const { return GetWord(word_index) == 0; }
+
+  /**
+   * Allocate the lowest free page recorded by a word of the bitmap.
+   *
+   * @param page_offset Index in extent of the page allocated.
+   * @param candidates Bit i is set if page i of the word may be allocated.
+   * @return true if the word had a free page among the candidates.
+   */
+  bool AllocatePageInWord(uint32_t word_index, uint32_t &page_offset, uint64_t candidates = ~uint64_t{0});
+
+  /**
+   * Mark every page of the extent free
+   */
+  void Reset() { memset(this, 0, PageSize); }
+
  unsigned char getb(uint32_t byte) {
   return this->bytes[byte];
  }
@@ -45,9 +77,13 @@ class BitmapPage {
   bool IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const;
 
   /**
-   * update next_free_page_
+   * @return a word of the bitmap, the bitmap is not necessarily aligned for a word access
    */
-  void FindNextFreePage();
+  uint64_t GetWord(uint32_t word_index) const {
+    uint64_t word;
+    memcpy(&word, bytes + word_index * sizeof(uint64_t), sizeof(word));
+    return word;
+  }
 
   /**
    * set a bit(byte_index, bit_index) in bytes to 1.
@@ -63,6 +99,9 @@ class BitmapPage {
   /** Note: need to update if modify page structure. */
   static constexpr size_t MAX_CHARS = PageSize - 2 * sizeof(uint32_t);
 
+  static_assert(MAX_CHARS % sizeof(uint64_t) == 0, "The bitmap must consist of whole words.");
+  static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Word-wide search assumes a little endian bitmap.");
+
  private:
   /** The space occupied by all members of the class should be equal to the PageSize */
   [[maybe_unused]] uint32_t page_allocated_;
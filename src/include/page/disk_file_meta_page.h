@@ -1,29 +1,74 @@
 #ifndef MINISQL_DISK_FILE_META_PAGE_H
 #define MINISQL_DISK_FILE_META_PAGE_H
 
+#include <cstddef>
 #include <cstdint>
 
 #include "page/bitmap_page.h"
 
-static constexpr page_id_t MAX_VALID_PAGE_ID = (PAGE_SIZE - 8) / 4 * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+static constexpr uint32_t DISK_FILE_META_HEADER_SIZE = 36;
+static constexpr page_id_t MAX_VALID_PAGE_ID = (page_id_t{1} << PAGE_ID_BITS) - 1;
 
+/**
+ * The first meta page of a db file describes the file and records the used pages of its first GetExtentsPerMetaPage
+ * extents. Every further GetExtentsPerMetaPage extents are recorded by a meta page of their own, which is chained to
+ * the meta page before it through next_meta_page_. Only num_extents_, page_size_ and the used pages are kept in a
+ * chained meta page, its num_extents_ counting the extents it records.
+ */
 class DiskFileMetaPage {
  public:
+  /**
+   * @return the number of extents a meta page of page_size bytes can record
+   */
+  static constexpr uint32_t GetExtentsPerMetaPage(uint32_t page_size) {
+    return (page_size - DISK_FILE_META_HEADER_SIZE) / sizeof(uint32_t);
+  }
+
   uint32_t GetExtentNums() { return num_extents_; }
 
-  uint32_t GetAllocatedPages() { return num_allocated_pages_; }
+  uint64_t GetAllocatedPages() { return num_allocated_pages_; }
+
+  /**
+   * @return the page size the file was created with, 0 for a file that has not been written yet
+   */
+  uint32_t GetPageSize() { return page_size_; }
+
+  /**
+   * @return the size of the page ids stored in the pages of the file, 0 for a file that has not been written yet
+   */
+  uint32_t GetPageIdSize() { return page_id_size_; }
 
+  /**
+   * @return whether the data pages are stored compressed in a CompressedPageStore
+   */
+  bool IsCompressed() { return compressed_ != 0; }
+
+  /**
+   * @return whether every table and index is kept in a tablespace file of its own
+   */
+  bool IsFilePerTable() { return file_per_table_ != 0; }
+
+  /**
+   * @param extent_id extent among the ones this meta page records
+   */
   uint32_t GetExtentUsedPage(uint32_t extent_id) {
-    if (extent_id >= num_extents_) {
+    if (extent_id >= num_extents_ || extent_id >= GetExtentsPerMetaPage(page_size_)) {
       return 0;
     }
     return extent_used_page_[extent_id];
   }
 
  public:
-  uint32_t num_allocated_pages_{0};
-  uint32_t num_extents_{0};  // each extent consists with a bit map and BIT_MAP_SIZE pages
+  uint64_t num_allocated_pages_{0};
+  uint64_t next_meta_page_{0};  // physical page id of the next meta page, 0 for the last one
+  uint32_t num_extents_{0};     // each extent consists with a bit map and BIT_MAP_SIZE pages
+  uint32_t page_size_{0};
+  uint32_t compressed_{0};
+  uint32_t file_per_table_{0};
+  uint32_t page_id_size_{0};
   uint32_t extent_used_page_[0];
 };
 
+static_assert(offsetof(DiskFileMetaPage, extent_used_page_) == DISK_FILE_META_HEADER_SIZE);
+
 #endif  // MINISQL_DISK_FILE_META_PAGE_H
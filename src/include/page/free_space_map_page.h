@@ -0,0 +1,98 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * A page of the free space map of a table heap. It records the free space of up to CAPACITY pages of the heap as a
+ * category of GetCategoryBytes(page_size) bytes each, rounded down, so a page of category c has room for at least c
+ * such units. The free space map pages of a heap are chained, the first one is recorded in the first page of the heap.
+ * Pages are recorded in the order they are appended to the heap, a page removed from the heap leaves an
+ * INVALID_PAGE_ID behind. The format fits in the smallest page size, the rest of a larger page is unused.
+ *
+ * Format (size in byte):
+ *  ------------------------------------------------------------------------------------------------
+ * | NextPageId (8) | Count (4) | Padding (4) | PageId_1 (8) | ... | PageId_n (8) | Category_1 (1) | ... |
+ *  ------------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+ public:
+  static constexpr uint32_t CAPACITY = (MIN_PAGE_SIZE - 16) / (sizeof(page_id_t) + 1);
+
+  /**
+   * @return the bytes of free space a category stands for in pages of page_size, so every category fits in a byte
+   */
+  static constexpr uint32_t GetCategoryBytes(uint32_t page_size) { return (page_size + 255) / 256; }
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetCount() const { return count_; }
+
+  bool IsFull() const { return count_ == CAPACITY; }
+
+  /**
+   * Record a page of the heap
+   * @return the slot of the page
+   */
+  uint32_t Add(page_id_t page_id, uint8_t category);
+
+  /**
+   * Forget the page in a slot, the slot is kept as INVALID_PAGE_ID with category 0 so no page is ever found in it
+   */
+  void Remove(uint32_t slot) {
+    page_ids_[slot] = INVALID_PAGE_ID;
+    categories_[slot] = 0;
+  }
+
+  page_id_t GetPageId(uint32_t slot) const { return page_ids_[slot]; }
+
+  void SetPageId(uint32_t slot, page_id_t page_id) { page_ids_[slot] = page_id; }
+
+  uint8_t GetCategory(uint32_t slot) const { return categories_[slot]; }
+
+  void SetCategory(uint32_t slot, uint8_t category) { categories_[slot] = category; }
+
+  /**
+   * @return the first slot whose page has at least category, -1 if there is none
+   */
+  int FindSlot(uint32_t category) const;
+
+  /**
+   * @return the highest category of the recorded pages
+   */
+  uint8_t GetMaxCategory() const;
+
+  /**
+   * @return the category of a page with free_bytes of free space
+   */
+  static uint8_t ToCategory(uint32_t free_bytes, uint32_t page_size) {
+    return free_bytes / GetCategoryBytes(page_size);
+  }
+
+  /**
+   * @return the lowest category guaranteeing room for bytes, above every category if bytes is close to page_size
+   */
+  static uint32_t NeededCategory(uint32_t bytes, uint32_t page_size) {
+    return (bytes + GetCategoryBytes(page_size) - 1) / GetCategoryBytes(page_size);
+  }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  [[maybe_unused]] uint32_t padding_;
+  page_id_t page_ids_[CAPACITY];
+  uint8_t categories_[CAPACITY];
+};
+
+static_assert(sizeof(FreeSpaceMapPage) <= MIN_PAGE_SIZE);
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
@@ -10,9 +10,9 @@
  * index's root page id
  *
  * Format (size in byte):
- *  -----------------------------------------------------------------
- * | RecordCount (4) | Index_1 id (4) | Index_1 root_id (4) | ... |
- *  -----------------------------------------------------------------
+ *  ------------------------------------------------------------------------------------------
+ * | RecordCount (4) | Padding (4) | Index_1 id (4) | Padding (4) | Index_1 root_id (8) | ... |
+ *  ------------------------------------------------------------------------------------------
  */
 class IndexRootsPage {
  public:
@@ -30,7 +30,7 @@ class IndexRootsPage {
   int GetIndexCount() { return count_; }
 
  private:
-  static constexpr int MAX_INDEX_COUNT = (PAGE_SIZE - 4) / 8;
+  static constexpr int MAX_INDEX_COUNT = (MIN_PAGE_SIZE - 8) / sizeof(std::pair<index_id_t, page_id_t>);
 
   int FindIndex(const index_id_t index_id);
 
@@ -1,8 +1,10 @@
 #ifndef MINISQL_PAGE_H
 #define MINISQL_PAGE_H
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <shared_mutex>
 
 #include "common/config.h"
@@ -12,6 +14,9 @@
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The page data is not part of the object: it lives in the frame arena of the buffer pool, so that the descriptors
+ * of all frames are packed together and every data buffer is aligned. Its size is the page size of the database.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
@@ -20,8 +25,11 @@ class Page {
  public:
   DISALLOW_COPY(Page)
 
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Zeros out the page data, which a page outside of a buffer pool owns itself. */
+  explicit Page(uint32_t page_size = DEFAULT_PAGE_SIZE)
+      : owned_data_(new char[page_size]), data_(owned_data_.get()), page_size_(page_size) {
+    ResetMemory();
+  }
 
   /** Default destructor. */
   ~Page() = default;
@@ -29,11 +37,14 @@ class Page {
   /** @return the actual data contained within this page */
   inline char *GetData() { return data_; }
 
+  /** @return the size of the page data in bytes */
+  inline uint32_t GetPageSize() { return page_size_; }
+
   /** @return the page id of this page */
   inline page_id_t GetPageId() { return page_id_; }
 
-  /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  /** @return the pin count of this page, 0 if the frame is free or being replaced */
+  inline int GetPinCount() { return pin_count_ > 0 ? pin_count_.load() : 0; }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
@@ -57,25 +68,37 @@ class Page {
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
 
  protected:
-  static_assert(sizeof(page_id_t) == 4);
+  static_assert(sizeof(page_id_t) == 8);
   static_assert(sizeof(lsn_t) == 4);
 
-  static constexpr size_t SIZE_PAGE_HEADER = 8;
+  static constexpr size_t SIZE_PAGE_HEADER = 12;
   static constexpr size_t OFFSET_PAGE_START = 0;
-  static constexpr size_t OFFSET_LSN = 4;
+  static constexpr size_t OFFSET_LSN = 8;
+
+  static constexpr int FRAME_LOCKED = -1;
 
  private:
-  /** Zeroes out the data that is held within the page. */
-  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
+  /** Constructor for a frame descriptor of the buffer pool, the data is owned by the frame arena. */
+  Page(char *frame_data, uint32_t page_size) : data_(frame_data), page_size_(page_size) {}
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** Zeroes out the data that is held within the page. */
+  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, page_size_); }
+
+  /** Data of a page that does not belong to a buffer pool. */
+  std::unique_ptr<char[]> owned_data_;
+  /** The actual data that is stored within a page, page_size_ bytes in the frame arena. */
+  char *data_{nullptr};
+  /** The page size of the database the page belongs to. */
+  uint32_t page_size_;
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /**
+   * The pin count of this page. The buffer pool holds it at FRAME_LOCKED while the frame is free or being replaced,
+   * so that lock-free fetches cannot pin it.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -10,11 +10,19 @@
  *
  *  Header format (size in bytes):
  *  ----------------------------------------------------------------------------
- *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
+ *  | PageId (8)| LSN (4)| FreeSpacePointer(4) | PrevPageId (8)| NextPageId (8)|
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------------
+ *  | FreeSpaceMapPageId (8) | TupleCount (4) | FreeSlotHint (4) | LiveTupleCount (4) |
+ *  ---------------------------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------------
+ *  | LiveSlotBitmap (page size / 64) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ---------------------------------------------------------------------------------------------
+ *
+ *  FreeSpaceMapPageId is the first free space map page of the heap in its first page, INVALID_PAGE_ID in the others.
+ *  No slot below FreeSlotHint is free (has size 0). LiveSlotBitmap has one bit per slot, set iff the slot holds a tuple
+ *  that is not deleted, and LiveTupleCount is the number of set bits, so finding a free slot or the next tuple skips
+ *  runs of tombstones a word at a time. The bitmap and everything after it depend on the page size of the database.
  **/
 
 #include <cstring>
@@ -25,6 +33,7 @@
 #include "concurrency/txn.h"
 #include "page/page.h"
 #include "record/row.h"
+#include "record/tuple_view.h"
 #include "recovery/log_manager.h"
 
 class TablePage : public Page {
@@ -33,6 +42,8 @@ class TablePage : public Page {
 
   page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
 
+  void SetTablePageId(page_id_t page_id) { memcpy(GetData(), &page_id, sizeof(page_id_t)); }
+
   page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
 
   page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
@@ -45,6 +56,20 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  page_id_t GetFreeSpaceMapPageId() {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_FREE_SPACE_MAP_PAGE_ID);
+  }
+
+  void SetFreeSpaceMapPageId(page_id_t free_space_map_page_id) {
+    memcpy(GetData() + OFFSET_FREE_SPACE_MAP_PAGE_ID, &free_space_map_page_id, sizeof(page_id_t));
+  }
+
+  uint32_t GetLiveTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_LIVE_TUPLE_COUNT); }
+
+  uint32_t GetFreeSpaceRemaining() {
+    return GetFreeSpacePointer() - GetHeaderSize() - SIZE_TUPLE * GetTupleCount();
+  }
+
   bool InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager);
 
   bool MarkDelete(const RowId &rid, Txn *txn, LockManager *lock_manager, LogManager *log_manager);
@@ -58,11 +83,50 @@ class TablePage : public Page {
 
   bool GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_manager);
 
+  /**
+   * Point view at the tuple of rid in this page instead of copying it out, the view does not pin the page
+   */
+  bool GetTupleView(const RowId &rid, Schema *schema, TupleView *view);
+
   bool GetFirstTupleRid(RowId *first_rid);
 
+  /**
+   * @return the bytes taken by tuples marked deleted, over the bytes a page has for tuples and slots
+   */
+  double GetDeadSpaceRatio();
+
+  /**
+   * @return the bytes of the tuple area, an upper bound on the bytes of the live tuples
+   */
+  uint32_t GetTupleAreaSize() { return GetPageSize() - GetFreeSpacePointer(); }
+
+  /**
+   * @return the bytes of the tuple area and the slots of the live tuples, over the bytes a page has for tuples and slots
+   */
+  double GetLiveSpaceRatio() {
+    return static_cast<double>(GetTupleAreaSize() + SIZE_TUPLE * GetLiveTupleCount()) /
+           (GetPageSize() - GetHeaderSize());
+  }
+
+  /**
+   * @return whether tuple_count tuples of tuple_bytes bytes in total fit in, reusing free slots
+   */
+  bool HasRoomFor(uint32_t tuple_bytes, uint32_t tuple_count);
+
+  /**
+   * Reclaim every tuple marked deleted, as if its delete was applied, and pack the remaining tuples in one pass. Slots
+   * at the end of the directory that are left free are given back as well.
+   */
+  void Vacuum(Txn *txn, LogManager *log_manager);
+
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
  private:
+  // every slot takes SIZE_TUPLE bytes of the directory, so a page never has more than page size / 8 of them
+  uint32_t GetLiveSlotBitmapSize() { return GetPageSize() / 8 / 8; }
+
+  uint32_t GetHeaderSize() { return OFFSET_LIVE_SLOT_BITMAP + GetLiveSlotBitmapSize(); }
+
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
   void SetFreeSpacePointer(uint32_t free_space_pointer) {
@@ -73,24 +137,47 @@ class TablePage : public Page {
 
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  uint32_t GetFreeSlotHint() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SLOT_HINT); }
+
+  void SetFreeSlotHint(uint32_t slot_num) { memcpy(GetData() + OFFSET_FREE_SLOT_HINT, &slot_num, sizeof(uint32_t)); }
+
+  void SetLiveTupleCount(uint32_t live_tuple_count) {
+    memcpy(GetData() + OFFSET_LIVE_TUPLE_COUNT, &live_tuple_count, sizeof(uint32_t));
+  }
+
+  bool IsLive(uint32_t slot_num) {
+    return (GetData()[OFFSET_LIVE_SLOT_BITMAP + slot_num / 8] >> (slot_num % 8)) & 1;
   }
 
+  /**
+   * Set or clear the live bit of a slot and keep the live tuple count in step
+   */
+  void SetLive(uint32_t slot_num, bool live);
+
+  /**
+   * @return the first slot at or after slot_num whose live bit equals live, GetTupleCount() if there is none
+   */
+  uint32_t FindSlot(uint32_t slot_num, bool live);
+
+  /**
+   * @return the first free slot at or after the free slot hint, GetTupleCount() if there is none
+   */
+  uint32_t FindFreeSlot();
+
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
-    return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
+    return *reinterpret_cast<uint32_t *>(GetData() + GetHeaderSize() + SIZE_TUPLE * slot_num);
   }
 
   void SetTupleOffsetAtSlot(uint32_t slot_num, uint32_t offset) {
-    memcpy(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num, &offset, sizeof(uint32_t));
+    memcpy(GetData() + GetHeaderSize() + SIZE_TUPLE * slot_num, &offset, sizeof(uint32_t));
   }
 
   uint32_t GetTupleSize(uint32_t slot_num) {
-    return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_SIZE + SIZE_TUPLE * slot_num);
+    return *reinterpret_cast<uint32_t *>(GetData() + GetHeaderSize() + 4 + SIZE_TUPLE * slot_num);
   }
 
   void SetTupleSize(uint32_t slot_num, uint32_t size) {
-    memcpy(GetData() + OFFSET_TUPLE_SIZE + SIZE_TUPLE * slot_num, &size, sizeof(uint32_t));
+    memcpy(GetData() + GetHeaderSize() + 4 + SIZE_TUPLE * slot_num, &size, sizeof(uint32_t));
   }
 
   static bool IsDeleted(uint32_t tuple_size) { return static_cast<bool>(tuple_size & DELETE_MASK) || tuple_size == 0; }
@@ -100,19 +187,26 @@ class TablePage : public Page {
   static uint32_t UnsetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size & (~DELETE_MASK)); }
 
  private:
-  static_assert(sizeof(page_id_t) == 4);
+  static_assert(sizeof(page_id_t) == 8);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
-  static constexpr size_t SIZE_TUPLE = 8;
-  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
-  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
-  static constexpr size_t OFFSET_FREE_SPACE = 16;
-  static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_FREE_SPACE = 12;
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 16;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 24;
+  static constexpr size_t OFFSET_FREE_SPACE_MAP_PAGE_ID = 32;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 40;
+  static constexpr size_t OFFSET_FREE_SLOT_HINT = 44;
+  static constexpr size_t OFFSET_LIVE_TUPLE_COUNT = 48;
+  static constexpr size_t OFFSET_LIVE_SLOT_BITMAP = 52;
 
  public:
-  static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
+  static constexpr size_t SIZE_TUPLE = 8;
+
+  /**
+   * @return the size of the largest row a table page of page_size holds
+   */
+  static constexpr uint32_t GetMaxRowSize(uint32_t page_size) {
+    return page_size - (OFFSET_LIVE_SLOT_BITMAP + page_size / 8 / 8) - SIZE_TUPLE;
+  }
 };
 
 #endif
\ No newline at end of file
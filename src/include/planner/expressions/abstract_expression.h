@@ -10,6 +10,7 @@
 
 #include "record/row.h"
 #include "record/schema.h"
+#include "record/tuple_view.h"
 
 class AbstractExpression;
 using AbstractExpressionRef = std::shared_ptr<AbstractExpression>;
@@ -36,6 +37,9 @@ class AbstractExpression {
   /** @return The field obtained by evaluating the row */
   virtual Field Evaluate(const Row *row) const = 0;
 
+  /** @return The field obtained by evaluating the row in place, only the columns the expression reads are decoded */
+  virtual Field Evaluate(const TupleView &view) const = 0;
+
   /**
    * Returns the field obtained by evaluating a JOIN.
    * @param left_row The left row
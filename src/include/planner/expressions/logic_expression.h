@@ -31,6 +31,18 @@ class LogicExpression : public AbstractExpression {
     return Field(kTypeInt, PerformComputation(lhs, rhs));
   }
 
+  /** the right side is not evaluated when the left side decides, so its columns are not decoded either */
+  Field Evaluate(const TupleView &view) const override {
+    Field lhs = GetChildAt(0)->Evaluate(view);
+    CmpBool l = GetFieldAsCmpBool(lhs);
+    if ((logic_type_ == LogicType::And && l == CmpBool::kFalse) ||
+        (logic_type_ == LogicType::Or && l == CmpBool::kTrue)) {
+      return Field(kTypeInt, l);
+    }
+    Field rhs = GetChildAt(1)->Evaluate(view);
+    return Field(kTypeInt, PerformComputation(lhs, rhs));
+  }
+
   Field EvaluateJoin(const Row *left_row, const Row *right_row) const override {
     Field lhs = GetChildAt(0)->EvaluateJoin(left_row, right_row);
     Field rhs = GetChildAt(1)->EvaluateJoin(left_row, right_row);
@@ -0,0 +1,87 @@
+#ifndef MINISQL_TUPLE_VIEW_H
+#define MINISQL_TUPLE_VIEW_H
+
+#include <vector>
+
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+class BufferPoolManager;
+
+/**
+ * TupleView reads the fields of a serialized row in place, see Row::SerializeTo for the format.
+ *
+ * Nothing is decoded up front, the offset of a field is found when the field is first asked for and remembered for
+ * the fields before it. Char fields point into the buffer instead of copying it, so evaluating a filter on a view
+ * allocates nothing, and only the rows that pass are turned into a Row by ToRow.
+ *
+ * A view handed out by TableHeap::GetTupleView keeps the page of its row pinned until it is released, reset or
+ * destroyed. Fields taken from the view must not outlive it.
+ */
+class TupleView {
+ public:
+  TupleView() = default;
+
+  /**
+   * View a row serialized in buf, the view does not hold a pin on it
+   */
+  TupleView(const char *buf, const Schema *schema, RowId rid = RowId()) { Reset(buf, schema, rid); }
+
+  TupleView(const TupleView &other) = delete;
+
+  TupleView &operator=(const TupleView &other) = delete;
+
+  ~TupleView() { Release(); }
+
+  /**
+   * Point the view at another row, releasing the page it was pinning
+   */
+  void Reset(const char *buf, const Schema *schema, RowId rid);
+
+  /**
+   * Make the view unpin the page of its row when it is released
+   */
+  void HoldPin(BufferPoolManager *buffer_pool_manager) { buffer_pool_manager_ = buffer_pool_manager; }
+
+  /**
+   * Unpin the page of the row if the view holds a pin, and leave the view empty
+   */
+  void Release();
+
+  inline bool IsValid() const { return buf_ != nullptr; }
+
+  inline RowId GetRowId() const { return rid_; }
+
+  inline uint32_t GetFieldCount() const { return schema_->GetColumnCount(); }
+
+  /**
+   * Decode a field, char data is copied only if manage_data is set
+   */
+  Field GetField(uint32_t idx, bool manage_data = false) const;
+
+  /**
+   * Copy every field into row, row owns its data afterwards
+   */
+  void ToRow(Row *row) const;
+
+  /**
+   * Copy the fields of the columns of output_schema into row, found by their index in the table schema
+   */
+  void ToRow(Row *row, const Schema *output_schema) const;
+
+ private:
+  /**
+   * @return offset of field idx in buf_, extending offsets_ up to it
+   */
+  uint32_t GetFieldOffset(uint32_t idx) const;
+
+  const char *buf_{nullptr};                         // the serialized row
+  const Schema *schema_{nullptr};                    // schema the row was serialized with
+  RowId rid_{};                                      // rid of the row
+  mutable std::vector<uint32_t> offsets_;            // offsets of the fields up to the last one decoded
+  BufferPoolManager *buffer_pool_manager_{nullptr};  // set if the view holds a pin on the page of rid_
+};
+
+#endif  // MINISQL_TUPLE_VIEW_H
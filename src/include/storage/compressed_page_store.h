@@ -0,0 +1,115 @@
+#ifndef MINISQL_COMPRESSED_PAGE_STORE_H
+#define MINISQL_COMPRESSED_PAGE_STORE_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * CompressedPageStore keeps pages compressed in a file of variable-size slots.
+ *
+ * A slot is a run of SECTOR_SIZE sectors holding a slot header and the page compressed by PageCodec, or the plain
+ * page if compression does not save a sector. An indirection map in memory tells the slot of every page. A page whose
+ * compressed size still needs the same number of sectors is rewritten in place, otherwise it moves to a free slot of
+ * the new size or to the end of the file, and its old slot becomes free once the new one is written.
+ *
+ * The map is not stored separately: every slot header records its page and a version, so the map and the free slots
+ * are rebuilt by walking the slot headers when the file is opened, the latest version of a page wins. A slot left
+ * torn at the end of the file by a crash ends the walk.
+ */
+class CompressedPageStore {
+ public:
+  /**
+   * Open the slot file, creating it if needed
+   * @param truncate drop every page the file holds
+   * @param page_size size of the pages stored, the page size of the db file
+   */
+  explicit CompressedPageStore(const std::string &file_name, bool truncate = false,
+                               uint32_t page_size = DEFAULT_PAGE_SIZE);
+
+  ~CompressedPageStore();
+
+  DISALLOW_COPY(CompressedPageStore);
+
+  /**
+   * @return the slot file of the pages of a db file, hidden next to it
+   */
+  static std::string GetFileName(const std::string &db_file);
+
+  /**
+   * Read a page, a page that was never written reads as zeroes
+   */
+  void ReadPage(page_id_t page_id, char *page_data);
+
+  void WritePage(page_id_t page_id, const char *page_data);
+
+  /**
+   * Free the slot of a page
+   */
+  void FreePage(page_id_t page_id);
+
+  /**
+   * Free the slots of the pages for which is_allocated is false, the pages stored since they were last written
+   */
+  void RetainPages(const std::function<bool(page_id_t)> &is_allocated);
+
+  /** @return the size of the slot file in bytes */
+  size_t GetFileSize();
+
+  /** @return the bytes of the slots holding pages */
+  size_t GetStoredBytes();
+
+  static constexpr size_t SECTOR_SIZE = 512;
+
+ private:
+  static constexpr uint32_t SLOT_MAGIC = 0x5a50534d;
+
+  struct SlotHeader {
+    uint32_t magic_;
+    page_id_t page_id_;
+    uint64_t version_;     // higher for a later write
+    uint32_t data_size_;   // bytes following the header
+    uint16_t sectors_;     // size of the slot
+    uint16_t compressed_;  // whether the data is compressed or the plain page
+  };
+
+  // sectors of a slot holding a plain page of the largest size
+  static constexpr size_t MAX_SLOT_SECTORS = (sizeof(SlotHeader) + MAX_PAGE_SIZE + SECTOR_SIZE - 1) / SECTOR_SIZE;
+
+  struct Slot {
+    uint64_t offset_{0};
+    uint32_t sectors_{0};  // 0 if the page has no slot
+  };
+
+  /**
+   * Rebuild the map and the free slots from the slot headers
+   */
+  void LoadSlots();
+
+  /**
+   * Take a free slot of sectors sectors or a new one at the end of the file, with latch_ held
+   * @return offset of the slot
+   */
+  uint64_t TakeSlot(uint32_t sectors);
+
+  /**
+   * Give a slot back, with latch_ held
+   */
+  void ReleaseSlot(const Slot &slot);
+
+  int fd_{-1};
+  uint32_t page_size_;
+  size_t slot_sectors_;  // sectors of a slot holding a plain page, the largest slot of the file
+  std::mutex latch_;
+  std::vector<Slot> slots_;                        // slot of every page, indexed by page id
+  std::vector<std::vector<uint64_t>> free_slots_;  // offsets of the free slots, indexed by their sectors
+  uint64_t end_{0};                                // end of the last slot
+  uint64_t version_{0};                            // version of the latest write
+  size_t stored_bytes_{0};
+};
+
+#endif  // MINISQL_COMPRESSED_PAGE_STORE_H
@@ -2,27 +2,83 @@
 #define DISK_MGR_H
 
 #include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/compressed_page_store.h"
+#include "storage/io_uring.h"
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
  *
- * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
+ * Disk page storage format: (Free Page BitMap Size = page size * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
+ * A meta page records DiskFileMetaPage::GetExtentsPerMetaPage extents (E), so another meta page, chained to the one
+ * before, precedes the extents E+1 to 2E and so on:
+ *      | Page EN | Meta Page 2 | Free Page BitMap E+1 | Page EN+1 | ... |
+ * Page ids are 64-bit, the file can grow to MAX_VALID_PAGE_ID pages.
+ *
+ * The page size is chosen when the file is created and recorded in its meta page, every page of the file, the meta
+ * pages and bitmaps included, has that size. An existing file is opened with the page size it records.
+ *
+ * With PREAD_IO the file is accessed through a file descriptor with pread/pwrite at explicit offsets, so concurrent
+ * page reads and writes do not share a stream cursor or a latch, and the file size is kept in memory. direct_io
+ * additionally opens the file with O_DIRECT, bypassing the OS page cache; buffers that are not MIN_PAGE_SIZE aligned are
+ * then copied through an aligned bounce buffer. FSTREAM_IO keeps the original std::fstream access.
+ *
+ * With IO_URING page reads and writes are queued on an io_uring and completed by a dedicated thread, so callers of
+ * ReadPageAsync and WritePageAsync can keep up to IO_URING_QUEUE_DEPTH page I/Os in flight. ReadPage and WritePage
+ * wait for their own completion. If the kernel does not support io_uring the disk manager falls back to PREAD_IO.
+ * The meta page and the bitmaps are always read and written synchronously.
+ *
+ * The meta page and all extent bitmaps are read when the file is opened and stay in memory, so allocating,
+ * de-allocating and checking pages does no disk I/O. They are written back by FlushMetaData and on Close. A free page
+ * is found through two summaries: a bit per extent telling whether the extent has a free page, and for every extent a
+ * bit per bitmap word telling whether the word has a free page.
+ *
+ * A file created with compress_pages keeps its data pages compressed in a CompressedPageStore next to it, whatever the
+ * I/O type. Page I/O then goes through the store one page at a time, and the extents of the db file only hold their
+ * bitmaps.
+ *
+ * The disk space of de-allocated pages is given back to the file system by punching holes into the db file, and
+ * Truncate cuts off the free pages at the end of the file, e.g. after StorageCompactor moved the pages to the front.
+ *
+ * A file created with file_per_table keeps every table and index in a tablespace file of its own, in a hidden
+ * directory next to the db file. The high TABLESPACE_ID_BITS bits of a page id name its tablespace, tablespace 0 being
+ * the db file itself with the catalog, and the low TABLESPACE_PAGE_BITS bits the page within it. Every tablespace file
+ * is managed by a disk manager of its own with the settings of the db file, so it has its own meta page and bitmaps,
+ * and the page I/O of a tablespace is routed to it. Dropping a table or index then simply unlinks its file.
  */
 class DiskManager {
  public:
-  explicit DiskManager(const std::string &db_file);
+  // called once the page I/O has completed, on the completion thread with IO_URING
+  using IOCallback = std::function<void()>;
+
+  /**
+   * @param compress_pages store the data pages of a new file compressed, an existing file keeps the choice it was
+   *                       created with
+   * @param file_per_table keep the tables and indexes of a new file in tablespace files, an existing file keeps the
+   *                       choice it was created with
+   * @param page_size page size of a new file, see IsValidPageSize, an existing file keeps the size it was created with
+   */
+  explicit DiskManager(const std::string &db_file, DiskIOType io_type = DEFAULT_DISK_IO_TYPE, bool direct_io = false,
+                       bool compress_pages = DEFAULT_COMPRESS_PAGES, bool file_per_table = DEFAULT_FILE_PER_TABLE,
+                       uint32_t page_size = DEFAULT_PAGE_SIZE);
 
   ~DiskManager() {
     if (!closed) {
@@ -42,22 +98,96 @@ class DiskManager {
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Start reading a page into page_data, callback is invoked when page_data holds the page. Backends without
+   * asynchronous I/O read the page right away and invoke callback before returning.
+   */
+  void ReadPageAsync(page_id_t logical_page_id, char *page_data, IOCallback callback);
+
+  /**
+   * Start writing page_data to a page, page_data has to stay unchanged until callback is invoked
+   */
+  void WritePageAsync(page_id_t logical_page_id, const char *page_data, IOCallback callback);
+
+  /**
+   * Read count consecutive logical pages starting at first_page_id, page i into page_data[i]. Pages that are
+   * contiguous on disk, i.e. within one extent, are read with a single preadv.
+   */
+  void ReadPages(page_id_t first_page_id, size_t count, char *const *page_data);
+
+  /**
+   * Read count consecutive logical pages starting at first_page_id into buf, which holds count * GetPageSize() bytes
+   */
+  void ReadPages(page_id_t first_page_id, size_t count, char *buf);
+
+  /**
+   * Write count consecutive logical pages starting at first_page_id, page i from page_data[i]. Pages that are
+   * contiguous on disk are written with a single pwritev.
+   */
+  void WritePages(page_id_t first_page_id, size_t count, const char *const *page_data);
+
+  /**
+   * Write count consecutive logical pages starting at first_page_id from buf, which holds count * GetPageSize() bytes
+   */
+  void WritePages(page_id_t first_page_id, size_t count, const char *buf);
+
   /**
    * Get next free page from disk
+   * @param space_id tablespace to allocate the page in, which is created if needed
    * @return logical page id of allocated page
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(space_id_t space_id = 0);
 
   /**
-   * Free this page and reset bit map
+   * Get the lowest free page whose id is residue modulo num_classes, so that pages routed by page_id % num_classes,
+   * e.g. to the instances of a ParallelBufferPoolManager, can be allocated for a given instance
+   * @param space_id tablespace to allocate the page in, which is created if needed
+   * @return logical page id of allocated page, INVALID_PAGE_ID if there isn't free page anymore
+   */
+  page_id_t AllocatePageInClass(uint32_t num_classes, uint32_t residue, space_id_t space_id = 0);
+
+  /**
+   * Allocate count consecutive pages, which are contiguous on disk as well. The run starts at a bitmap word with every
+   * page free, so count is at most 64.
+   * @param space_id tablespace to allocate the pages in, which is created if needed
+   * @return logical page id of the first page of the run, INVALID_PAGE_ID if no bitmap word is free
+   */
+  page_id_t AllocatePages(size_t count, space_id_t space_id = 0);
+
+  /**
+   * Free this page and reset bit map. Its disk space is given back by the next FlushMetaData.
    */
   void DeAllocatePage(page_id_t logical_page_id);
 
+  /**
+   * Free count consecutive pages of one tablespace. The next FlushMetaData punches the holes of pages that are
+   * contiguous on disk at once.
+   */
+  void DeAllocatePages(page_id_t first_page_id, size_t count);
+
   /**
    * Return whether specific logical_page_id is free
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * @return one past the highest allocated page within a tablespace, 0 if it has no page allocated
+   */
+  page_id_t GetPageEnd(space_id_t space_id = 0);
+
+  /**
+   * Drop the extents without allocated pages at the end of the db file and of every tablespace file, and shrink the
+   * files to their last allocated page. The caller flushes the data pages first.
+   */
+  void Truncate();
+
+  /**
+   * Write the bitmaps modified since the last flush and the meta page to disk. Pages allocated since are only
+   * recorded as allocated on disk afterwards, so the caller flushes the data pages first. The pages freed since that
+   * are still free are punched out of the file once their bitmaps are on disk.
+   */
+  void FlushMetaData();
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
@@ -69,13 +199,78 @@ class DiskManager {
    */
   char *GetMetaData() { return meta_data_; }
 
-  static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+  /**
+   * @return the page size of the file in bytes
+   */
+  uint32_t GetPageSize() const { return page_size_; }
+
+  /**
+   * @return the number of pages of an extent, recorded by one bitmap page
+   */
+  size_t GetBitmapSize() const { return bitmap_size_; }
+
+  /**
+   * @return whether the file was opened with O_DIRECT
+   */
+  bool IsDirectIO() const { return direct_io_; }
+
+  /**
+   * @return how the db file is accessed, which differs from the requested type after a fallback
+   */
+  DiskIOType GetIOType() const { return io_type_; }
+
+  /**
+   * @return the store of the compressed data pages, nullptr if the data pages are stored plain
+   */
+  CompressedPageStore *GetPageStore() { return page_store_.get(); }
+
+  /**
+   * @return whether the tables and indexes are kept in tablespace files
+   */
+  bool IsFilePerTable() const { return file_per_table_; }
+
+  /**
+   * @return the tablespace of a table, 0 without tablespace files or if the table id has no tablespace id left
+   */
+  space_id_t GetTableSpace(table_id_t table_id) const;
+
+  /**
+   * @return the tablespace of an index, 0 without tablespace files or if the index id has no tablespace id left
+   */
+  space_id_t GetIndexSpace(index_id_t index_id) const;
+
+  /**
+   * Close the file of a tablespace and remove it. Its pages read as zeros afterwards and writes to them are dropped,
+   * the buffer pool discards them first.
+   */
+  void DropSpace(space_id_t space_id);
+
+  /**
+   * @return whether a tablespace has a file
+   */
+  bool HasSpace(space_id_t space_id);
+
+  /**
+   * @return the directory of the tablespace files of a db file, hidden next to it
+   */
+  static std::string GetSpaceDirectory(const std::string &db_file);
+
+  static space_id_t GetSpaceId(page_id_t page_id) { return static_cast<uint64_t>(page_id) >> TABLESPACE_PAGE_BITS; }
+
+  static page_id_t GetSpacePageId(page_id_t page_id) { return page_id & (SPACE_PAGES - 1); }
+
+  static page_id_t MakePageId(space_id_t space_id, page_id_t space_page_id) {
+    return static_cast<page_id_t>(space_id) << TABLESPACE_PAGE_BITS | space_page_id;
+  }
+
+  static constexpr page_id_t SPACE_PAGES = page_id_t{1} << TABLESPACE_PAGE_BITS;  // pages a tablespace can hold
+  static constexpr space_id_t MAX_SPACES = space_id_t{1} << TABLESPACE_ID_BITS;
 
  private:
   /**
    * Helper function to get disk file size
    */
-  int GetFileSize(const std::string &file_name);
+  int64_t GetFileSize(const std::string &file_name);
 
   /**
    * Read physical page from disk
@@ -87,19 +282,219 @@ class DiskManager {
    */
   void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
 
+  /**
+   * Read count physical pages starting at physical_page_id with one preadv
+   */
+  void ReadPhysicalPages(page_id_t physical_page_id, size_t count, char *const *page_data);
+
+  /**
+   * Write count physical pages starting at physical_page_id with one pwritev
+   */
+  void WritePhysicalPages(page_id_t physical_page_id, size_t count, const char *const *page_data);
+
+  /**
+   * @return how many of count logical pages starting at logical_page_id are contiguous on disk and fit one vectored
+   * I/O
+   */
+  size_t ContiguousRun(page_id_t logical_page_id, size_t count);
+
   /**
    * Map logical page id to physical page id
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
+  /**
+   * @return the physical page id of a meta page, 0 for the first one
+   */
+  page_id_t MetaPhysicalPageId(uint32_t meta_page_index) const;
+
+  /**
+   * @return the physical page id of the bitmap of an extent
+   */
+  page_id_t BitmapPhysicalPageId(uint32_t extent_id) const;
+
+  /**
+   * Open the db file as a file descriptor, creating it if needed
+   */
+  void OpenFile(const std::string &db_file);
+
+  /**
+   * Open the db file as a stream, creating it if needed
+   */
+  void OpenStream(const std::string &db_file);
+
+  /**
+   * Stop the page I/O and close the db file without writing anything
+   */
+  void CloseFile();
+
+  /**
+   * Read the chained meta pages and the bitmaps of all extents recorded in them and build their summaries
+   */
+  void LoadExtents();
+
+  /**
+   * @return the meta page recording an extent
+   */
+  DiskFileMetaPage *GetMetaPage(uint32_t extent_id);
+
+  /**
+   * @return the used pages of an extent as recorded in its meta page
+   */
+  uint32_t &ExtentUsedPage(uint32_t extent_id);
+
+  /**
+   * Start a new extent with every page free
+   */
+  void AddExtent();
+
+  /**
+   * Allocate the lowest free page recorded by a word of the bitmap of an extent and update the summaries
+   * @param candidates bit i is set if page i of the word may be allocated
+   * @return logical page id of the page, INVALID_PAGE_ID if none of the candidates is free
+   */
+  page_id_t AllocatePageInWord(uint32_t extent_id, uint32_t word_index, uint64_t candidates = ~uint64_t{0});
+
+  /**
+   * Clear the bit of a page in its bitmap and free its slot in the page store
+   * @return false if the page was free already
+   */
+  bool DeAllocatePageBit(page_id_t logical_page_id);
+
+  /**
+   * Give the disk space of count physical pages starting at physical_page_id back to the file system, the pages then
+   * read as zeros
+   */
+  void PunchHoles(page_id_t physical_page_id, size_t count);
+
+  /**
+   * Punch the holes of the pages freed since the last flush, skipping the ones allocated again since
+   */
+  void PunchFreedPages();
+
+  /**
+   * Reserve disk space up to physical_page_id ahead of the writes, in chunks of FILE_GROW_PAGES pages, so that the file
+   * system can keep the pages of the file contiguous
+   */
+  void PreallocateFile(page_id_t physical_page_id);
+
+  /**
+   * @return whether page_id belongs to a tablespace file rather than to this file
+   */
+  bool IsSpacePage(page_id_t page_id) const { return file_per_table_ && GetSpaceId(page_id) != 0; }
+
+  /**
+   * Open the files of the tablespaces found in the tablespace directory
+   * @param new_file the db file is new, tablespaces left by an earlier file of the same name are removed instead
+   */
+  void LoadSpaces(bool new_file);
+
+  /**
+   * Open the file of a tablespace, creating it if needed
+   */
+  std::unique_ptr<DiskManager> OpenSpace(space_id_t space_id);
+
+  /**
+   * @return the disk manager of a tablespace, created if needed, with lock re-acquired on spaces_latch_
+   */
+  DiskManager *GetOrCreateSpace(space_id_t space_id, std::shared_lock<std::shared_mutex> *lock);
+
+  /**
+   * Set up the io_uring and its completion thread, falls back to PREAD_IO if io_uring is not available
+   */
+  void StartIOUring();
+
+  /**
+   * Wait for the page I/Os in flight and stop the completion thread
+   */
+  void StopIOUring();
+
+  /**
+   * A page read or write submitted to the io_uring
+   */
+  struct PageIO {
+    bool write_;
+    char *page_data_;
+    char *bounce_buffer_;  // aligned copy of page_data for direct I/O, or nullptr
+    size_t offset_;
+    IOCallback callback_;
+  };
+
+  /**
+   * Submit a page I/O to the io_uring, blocks while IO_URING_QUEUE_DEPTH page I/Os are in flight
+   */
+  void SubmitPageIO(bool write, page_id_t physical_page_id, char *page_data, IOCallback callback);
+
+  /**
+   * Finish a page I/O with the result of its completion and invoke its callback
+   */
+  void CompletePageIO(PageIO *io, int res);
+
+  /**
+   * Loop of the completion thread
+   */
+  void CompletionLoop();
+
+  /**
+   * Remember that the file now extends to at least end bytes
+   */
+  void GrowFileSize(size_t end);
+
  private:
-  // stream to write db file
+  DiskIOType io_type_;
+  // descriptor of the db file with PREAD_IO
+  int db_fd_{-1};
+  bool direct_io_{false};
+  // size of the db file in bytes with PREAD_IO, only grows
+  std::atomic<size_t> file_size_{0};
+  // bytes of disk space reserved for the db file with PREAD_IO, guarded by db_io_latch_
+  size_t preallocated_size_{0};
+  // data pages of a compressed file, the db file then only holds the meta page and the bitmaps
+  std::unique_ptr<CompressedPageStore> page_store_;
+  // whether the tables and indexes live in tablespace files
+  bool file_per_table_{false};
+  // page size of the file, read from its meta page
+  uint32_t page_size_{MIN_PAGE_SIZE};
+  // pages of an extent
+  size_t bitmap_size_;
+  // extents recorded by a meta page
+  uint32_t extents_per_meta_page_;
+  // extents this file can grow to, fewer if its page ids have TABLESPACE_PAGE_BITS bits
+  uint32_t max_extents_;
+  // disk managers of the tablespace files indexed by tablespace id, nullptr for tablespaces without a file
+  std::vector<std::unique_ptr<DiskManager>> spaces_;
+  // held shared while a tablespace is in use, exclusively while one is opened or dropped
+  std::shared_mutex spaces_latch_;
+  // io_uring of the db file with IO_URING, completions are reaped by io_completer_
+  std::unique_ptr<IoUring> io_uring_;
+  std::thread io_completer_;
+  std::mutex io_latch_;
+  std::condition_variable io_cv_;  // signaled when a page I/O completes
+  size_t io_in_flight_{0};         // page I/Os submitted to the io_uring and not completed yet
+  /**
+   * The bitmap of an extent held in memory, sized for the largest page size. The first page_size_ bytes of it are a
+   * bitmap page of the file, the words after them are never used.
+   */
+  struct alignas(MIN_PAGE_SIZE) Extent {
+    static constexpr size_t SUMMARY_WORDS = (BitmapPage<MAX_PAGE_SIZE>::GetWordCount() + 63) / 64;
+
+    BitmapPage<MAX_PAGE_SIZE> bitmap_;
+    uint64_t free_words_[SUMMARY_WORDS];  // bit w is set if word w of bitmap_ has a free page
+    bool dirty_{false};                   // whether bitmap_ differs from the bitmap on disk
+  };
+  std::vector<std::unique_ptr<Extent>> extents_;
+  std::vector<uint64_t> free_extents_;  // bit e is set if extent e has a free page
+  // runs of logical pages freed since the last flush, a crash must not find a page zeroed the bitmap on disk still has
+  std::vector<std::pair<page_id_t, size_t>> freed_pages_;
+  // stream to write db file with FSTREAM_IO
   std::fstream db_io_;
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
+  // protects the meta page and the bitmaps, and file access with FSTREAM_IO
   std::recursive_mutex db_io_latch_;
   bool closed{false};
-  char meta_data_[PAGE_SIZE];
+  char meta_data_[MAX_PAGE_SIZE];
+  // meta pages after the first one, each recording the next extents_per_meta_page_ extents
+  std::vector<std::unique_ptr<char[]>> meta_pages_;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef MINISQL_IO_URING_H
+#define MINISQL_IO_URING_H
+
+#include <cstdint>
+#include <mutex>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+/**
+ * IoUring is a minimal io_uring instance speaking the kernel interface directly: reads and writes at explicit offsets
+ * are queued on the submission ring, and their results are reaped from the completion ring.
+ *
+ * Submit may be called by several threads, WaitCompletion by one thread at a time. The caller has to keep the number
+ * of operations in flight at or below the number of entries, the completion ring is not allowed to overflow.
+ */
+class IoUring {
+ public:
+  /**
+   * Set up a ring with room for entries operations, IsOpen tells whether the kernel supports io_uring
+   */
+  explicit IoUring(unsigned entries);
+
+  ~IoUring();
+
+  DISALLOW_COPY(IoUring);
+
+  /** @return whether the ring was set up */
+  inline bool IsOpen() const { return ring_fd_ >= 0; }
+
+  /**
+   * Queue a read (or write) of len bytes of fd at offset into (from) buf, and hand it to the kernel
+   * @param user_data returned with the completion of the operation
+   * @return false if the kernel refused the operation, it will not complete then
+   */
+  bool Submit(bool write, int fd, void *buf, uint32_t len, uint64_t offset, uint64_t user_data);
+
+  /**
+   * Queue an operation that does nothing but complete, e.g. to wake up the thread waiting for completions
+   */
+  bool SubmitNop(uint64_t user_data);
+
+  /**
+   * Wait until an operation completes
+   * @param[out] user_data user_data of the operation
+   * @param[out] res result of the operation, the number of bytes transferred or -errno
+   * @return false on an error of the ring itself
+   */
+  bool WaitCompletion(uint64_t *user_data, int *res);
+
+ private:
+  /** Fill the next submission queue entry and submit it, the caller holds submit_latch_ */
+  bool SubmitEntry(uint8_t opcode, int fd, void *buf, uint32_t len, uint64_t offset, uint64_t user_data);
+
+ private:
+  int ring_fd_{-1};
+  std::mutex submit_latch_;  // serializes producers of the submission ring
+  // submission ring
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  // completion ring, shares the mapping of the submission ring if the kernel supports it
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  void *cqes_{nullptr};
+};
+
+#endif  // MINISQL_IO_URING_H
@@ -0,0 +1,31 @@
+#ifndef MINISQL_PAGE_CODEC_H
+#define MINISQL_PAGE_CODEC_H
+
+#include <cstddef>
+
+/**
+ * PageCodec is a small LZ4 block format compressor for pages.
+ *
+ * A block is a sequence of a token byte (literal length in the high 4 bits, match length - 4 in the low 4 bits),
+ * the literal length beyond 15 as a run of 255s and a remainder, the literals, a 2-byte little-endian match offset and
+ * the match length beyond 15. The last sequence holds literals only. Matches are found greedily through a hash table of
+ * 4-byte prefixes, which is fast and does well on the zero padding and repeated keys of pages.
+ *
+ * Inputs are at most 64K, so that every offset fits the 2 bytes.
+ */
+class PageCodec {
+ public:
+  /**
+   * Compress src into dst
+   * @return size of the compressed block, 0 if it does not fit dst_capacity bytes
+   */
+  static size_t Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity);
+
+  /**
+   * Decompress a block of src_size bytes into dst
+   * @return true if the block is well formed and decompresses to exactly dst_size bytes
+   */
+  static bool Decompress(const char *src, size_t src_size, char *dst, size_t dst_size);
+};
+
+#endif  // MINISQL_PAGE_CODEC_H
@@ -0,0 +1,97 @@
+#ifndef MINISQL_STORAGE_COMPACTOR_H
+#define MINISQL_STORAGE_COMPACTOR_H
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/dberr.h"
+#include "storage/disk_manager.h"
+
+/**
+ * StorageCompactor shrinks a database file offline, like VACUUM FULL.
+ *
+ * It walks everything reachable from the catalog meta page and the index roots page: the table and index meta pages,
+ * the page chain and the free space map of every table heap and the pages of every B+ tree. Allocated pages it does not
+ * reach, e.g. the meta page of a dropped table, are freed. Then the live pages at the end of every tablespace are moved
+ * into the lowest free pages, highest page into lowest hole, as long as that moves a page down. The references to a
+ * moved page are rewritten through the buffer pool first: the maps of the catalog meta page, the roots in the index
+ * roots page, the first page of a table meta page, the own, previous, next and free space map page ids of a table page,
+ * the next and the recorded page ids of a free space map page, and the own, parent, child and next page ids of a B+
+ * tree page as well as the row ids in its leaves. After the buffer pool is flushed and emptied, the pages are copied on
+ * disk, their old places are freed, punching holes, and the files are truncated behind their last page.
+ *
+ * Nothing may use the buffer pool meanwhile, so the catalog manager has to be closed while compacting, see
+ * DBStorageEngine::Compact. A crash in the middle leaves the references rewritten but the pages not yet moved.
+ */
+class StorageCompactor {
+ public:
+  StorageCompactor(BufferPoolManager *buffer_pool_manager, DiskManager *disk_manager)
+      : buffer_pool_manager_(buffer_pool_manager), disk_manager_(disk_manager) {}
+
+  /**
+   * @return DB_FAILED if a page is still pinned
+   */
+  dberr_t Compact();
+
+  /** @return pages freed because nothing referenced them */
+  size_t GetFreedPages() const { return freed_pages_; }
+
+  /** @return pages moved toward the front of their file */
+  size_t GetMovedPages() const { return moved_pages_; }
+
+ private:
+  /**
+   * Collect the table meta, index meta, table and B+ tree pages reachable from the catalog
+   */
+  void CollectPages();
+
+  void CollectFreeSpaceMapPages(page_id_t page_id);
+
+  void CollectTreePages(page_id_t page_id);
+
+  /**
+   * Free the allocated pages that were not collected
+   */
+  void FreeUnreachablePages();
+
+  /**
+   * Pair the last pages of every tablespace with its lowest free pages
+   */
+  void PlanMoves();
+
+  /**
+   * Rewrite every reference to a page that moves
+   */
+  void RemapReferences();
+
+  void RemapTreePage(page_id_t page_id);
+
+  /**
+   * Copy the pages to their new places on disk and free the old ones
+   */
+  void MovePages();
+
+  /** @return the page page_id moves to, page_id itself if it stays */
+  page_id_t Remap(page_id_t page_id) const;
+
+  /** @return the tablespace of a page */
+  space_id_t SpaceOf(page_id_t page_id) const;
+
+  BufferPoolManager *buffer_pool_manager_;
+  DiskManager *disk_manager_;
+  std::vector<index_id_t> index_ids_;
+  std::set<page_id_t> table_meta_pages_;
+  std::set<page_id_t> table_pages_;
+  std::set<page_id_t> fsm_pages_;
+  std::set<page_id_t> tree_pages_;
+  std::set<page_id_t> live_pages_;                  // every collected page
+  std::unordered_map<page_id_t, page_id_t> moves_;  // old page id to new page id
+  std::map<page_id_t, page_id_t> moves_by_target_;  // new page id to old page id
+  size_t freed_pages_{0};
+  size_t moved_pages_{0};
+};
+
+#endif  // MINISQL_STORAGE_COMPACTOR_H
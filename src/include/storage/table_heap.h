@@ -1,28 +1,52 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
+#include "page/free_space_map_page.h"
 #include "page/header_page.h"
 #include "page/table_page.h"
 #include "recovery/log_manager.h"
 #include "storage/table_iterator.h"
 
+/**
+ * A table heap is a doubly linked chain of table pages. Inserts find a page with room through the free space map of
+ * the heap, see FreeSpaceMapPage, which is kept up to date by every insert, update and delete, instead of walking the
+ * chain. Its pages are read into memory on the first change of an existing heap, together with the highest category
+ * every free space map page may hold, so finding a page fetches no more than a few pages.
+ *
+ * Deleted tuples are reclaimed by Vacuum, usually from a VacuumWorker. The heap remembers the pages that had deletes
+ * since they were last visited, every page of a heap opened from disk counts as such until it is visited once.
+ */
 class TableHeap {
   friend class TableIterator;
 
  public:
+  /**
+   * Called for a tuple Vacuum moved to another page, with its old rid, row holds the tuple and its new rid
+   */
+  using RelocateCallback = std::function<void(Row &row, const RowId &old_rid)>;
+
+  /**
+   * @param space_id tablespace the pages of the heap are allocated in
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Txn *txn, LogManager *log_manager,
-                           LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
+                           LockManager *lock_manager, space_id_t space_id = 0) {
+    return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager, space_id);
   }
 
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+                           LogManager *log_manager, LockManager *lock_manager, space_id_t space_id = 0) {
+    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager, space_id);
   }
 
-  ~TableHeap() {}
+  ~TableHeap() { buffer_pool_manager_->ReleasePages(&reservation_); }
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
@@ -32,6 +56,16 @@ class TableHeap {
    */
   bool InsertTuple(Row &row, Txn *txn);
 
+  /**
+   * Append tuples to the end of the table, for bulk loads. The last page stays pinned and write latched while it is
+   * filled, and is only unpinned and recorded in the free space map once it is full and the next page is linked behind
+   * it. Space freed in earlier pages is not reused.
+   * @param[in/out] rows Tuple Rows to insert, the rids of the inserted tuples are wrapped in the objects
+   * @param[in] txn The recovery performing the insert
+   * @return true iff all rows were inserted, the rows up to the first that failed are inserted otherwise
+   */
+  bool BulkInsert(std::vector<Row> &rows, Txn *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -71,7 +105,25 @@ class TableHeap {
    */
   bool GetTuple(Row *row, Txn *txn);
 
+  /**
+   * Read a tuple in place, see TupleView.
+   * @param[in] rid row id of the tuple
+   * @param[out] view points into the page of the tuple and keeps it pinned until released
+   * @param[in] txn recovery performing the read
+   * @param[in] bulk_read fetch the page through the bulk read ring
+   * @return true if the tuple exists
+   */
+  bool GetTupleView(const RowId &rid, TupleView *view, Txn *txn, bool bulk_read = false);
+
   void FreeTableHeap() {
+    // a heap with a tablespace of its own goes away with the file
+    if (reservation_.space_id_ != 0) {
+      buffer_pool_manager_->ReleasePages(&reservation_);
+      buffer_pool_manager_->DropSpace(reservation_.space_id_);
+      first_page_id_ = INVALID_PAGE_ID;
+      return;
+    }
+    DeleteFreeSpaceMap();
     auto next_page_id = first_page_id_;
     while (next_page_id != INVALID_PAGE_ID) {
       auto old_page_id = next_page_id;
@@ -81,17 +133,32 @@ class TableHeap {
       buffer_pool_manager_->UnpinPage(old_page_id, false);
       buffer_pool_manager_->DeletePage(old_page_id);
     }
+    buffer_pool_manager_->ReleasePages(&reservation_);
   }
 
+  /**
+   * Visit pages that had deletes. A page whose deleted tuples take at least VACUUM_DEAD_RATIO of it is compacted, see
+   * TablePage::Vacuum, and its free space map entry updated. A page other than the first one whose live tuples take no
+   * more than VACUUM_MERGE_RATIO of it is merged into its previous page if they fit there, and taken out of the chain
+   * and freed. Pages with live tuples are only merged given on_move, as their tuples get new rids.
+   * No other operation may run on the heap meanwhile, the pages are read through the bulk read ring of the buffer pool.
+   * @param max_pages pages to visit at most
+   * @param on_move called for every tuple moved to another page, to update the indexes of the table
+   * @return the number of pages visited, 0 if no page had deletes
+   */
+  size_t Vacuum(size_t max_pages, const RelocateCallback &on_move = nullptr);
+
   /**
    * Free table heap and release storage in disk file
    */
   void DeleteTable(page_id_t page_id = INVALID_PAGE_ID);
 
   /**
+   * @param bulk_read true for a large sequential scan, whose pages then go through the bulk read ring of the buffer
+   *                  pool and do not evict the pages of concurrent point lookups
    * @return the begin iterator of this table
    */
-  TableIterator Begin(Txn *txn);
+  TableIterator Begin(Txn *txn, bool bulk_read = false);
 
   /**
    * @return the end iterator of this table
@@ -108,18 +175,24 @@ class TableHeap {
    * create table heap and initialize first page
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Txn *txn, LogManager *log_manager,
-                     LockManager *lock_manager)
+                     LockManager *lock_manager, space_id_t space_id)
       : buffer_pool_manager_(buffer_pool_manager),
         schema_(schema),
         log_manager_(log_manager),
         lock_manager_(lock_manager) {
+        reservation_.space_id_ = space_id;
+        // the free space map goes first, so it does not come between the pages of the heap
+        CreateFreeSpaceMap();
         // assign a new page for table heap (as its first page)
-        TablePage *page = reinterpret_cast<TablePage *>(buffer_pool_manager->NewPage(first_page_id_));
+        TablePage *page = reinterpret_cast<TablePage *>(buffer_pool_manager->NewPage(first_page_id_, &reservation_));
         // make sure there is enough page
         ASSERT(page != nullptr, "There isn't enough page");
         // initialize the page
         page->Init(first_page_id_, INVALID_PAGE_ID, log_manager,txn);
         page->SetNextPageId(INVALID_PAGE_ID);
+        page->SetFreeSpaceMapPageId(fsm_pages_.front());
+        RegisterPage(first_page_id_, page->GetFreeSpaceRemaining());
+        last_page_id_ = first_page_id_;
 
         // after initializing (becomes dirty), unpin it
         buffer_pool_manager->UnpinPage(first_page_id_, true);
@@ -127,12 +200,60 @@ class TableHeap {
   };
 
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+                     LogManager *log_manager, LockManager *lock_manager, space_id_t space_id)
       : buffer_pool_manager_(buffer_pool_manager),
         first_page_id_(first_page_id),
         schema_(schema),
         log_manager_(log_manager),
-        lock_manager_(lock_manager) {}
+        lock_manager_(lock_manager),
+        vacuum_all_(true) {
+    reservation_.space_id_ = space_id;
+  }
+
+  /**
+   * Start the empty free space map of a new heap
+   */
+  void CreateFreeSpaceMap();
+
+  /**
+   * Read the free space map of an existing heap into memory and find its last page
+   * @return false if the pages could not be fetched
+   */
+  bool LoadFreeSpaceMap();
+
+  /**
+   * @return a page whose category is at least category, INVALID_PAGE_ID if there is none
+   */
+  page_id_t FindPageWithSpace(uint32_t category);
+
+  /**
+   * Record the free space a page is left with in the free space map
+   */
+  void UpdateFreeSpace(page_id_t page_id, uint32_t free_bytes);
+
+  /**
+   * Record a new page in the last free space map page, chaining a new one if it is full
+   */
+  void RegisterPage(page_id_t page_id, uint32_t free_bytes);
+
+  /**
+   * Create a new page at the end of the heap
+   * @return the new page pinned, nullptr if the buffer pool or the disk is full
+   */
+  TablePage *AppendPage(page_id_t &page_id, Txn *txn);
+
+  void DeleteFreeSpaceMap();
+
+  /**
+   * Compact a page and merge it into its previous page if it is nearly empty, see Vacuum
+   */
+  void VacuumPage(page_id_t page_id, const RelocateCallback &on_move);
+
+  /**
+   * Move the tuples of a write latched page to its previous page and take it out of the chain and the free space map
+   * @return false if they do not fit, or the pages around could not be fetched
+   */
+  bool MergeIntoPrev(TablePage *page, const RelocateCallback &on_move);
 
  private:
   BufferPoolManager *buffer_pool_manager_;
@@ -140,6 +261,14 @@ class TableHeap {
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  PageReservation reservation_;  // run of pages new pages of the heap are taken from
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+  // the free space map in memory, empty until it is loaded
+  std::vector<page_id_t> fsm_pages_;         // free space map pages in chain order
+  std::vector<uint8_t> fsm_max_categories_;  // no page recorded in a free space map page has a higher category
+  std::unordered_map<page_id_t, std::pair<uint32_t, uint32_t>> fsm_slots_;  // page to free space map page and slot
+  std::unordered_set<page_id_t> vacuum_pages_;  // pages with deletes since the vacuum last visited them
+  bool vacuum_all_{false};                      // whether the vacuum has to visit every page first
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
@@ -4,15 +4,16 @@
 #include "common/rowid.h"
 #include "concurrency/txn.h"
 #include "record/row.h"
+#include "record/tuple_view.h"
 
 class TableHeap;
 
 class TableIterator {
 public:
  // you may define your own constructor based on your member variables
-  explicit TableIterator(TableHeap *table_heap, RowId rid, Txn *txn);
+  explicit TableIterator(TableHeap *table_heap, RowId rid, Txn *txn, bool bulk_read = false);
 
-  explicit TableIterator(TableHeap *table_heap, Row row_, Txn *txn);
+  explicit TableIterator(TableHeap *table_heap, Row row_, Txn *txn, bool bulk_read = false);
 
   explicit TableIterator(const TableIterator &other);
 
@@ -26,6 +27,11 @@ public:
 
   Row *operator->();
 
+  /**
+   * Read the current row in place, it is only copied into the row of the iterator on first dereference
+   */
+  bool GetView(TupleView *view);
+
   TableIterator &operator=(const TableIterator &itr) noexcept;
 
   TableIterator &operator++();
@@ -36,6 +42,8 @@ private:
   // add your own private member variables here
   TableHeap *table_heap;
   Row row;
+  bool row_loaded_{false};  // the fields of row are read, only its rid is kept up to date otherwise
+  bool bulk_read_{false};  // fetch pages through the bulk read ring of the buffer pool
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
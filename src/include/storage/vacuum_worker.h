@@ -0,0 +1,77 @@
+#ifndef MINISQL_VACUUM_WORKER_H
+#define MINISQL_VACUUM_WORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "storage/table_heap.h"
+
+/**
+ * VacuumWorker reclaims the space of deleted tuples in the background, like autovacuum, see TableHeap::Vacuum.
+ *
+ * Every VACUUM_INTERVAL_MS it runs a round visiting at most VACUUM_PAGES_PER_ROUND pages of the tables the table source
+ * lists, picking up where the last round stopped. Foreground work holds the shared side of its latch, see Foreground,
+ * and a round needs the exclusive side but only tries to take it. So a round never runs alongside a statement, never
+ * makes one wait for more than the pages of one round, and a busy database is not vacuumed until it goes idle.
+ */
+class VacuumWorker {
+ public:
+  struct Table {
+    TableHeap *table_heap_;
+    TableHeap::RelocateCallback on_move_;  // updates the indexes of the table, see TableHeap::Vacuum
+  };
+
+  /**
+   * Called at the start of every round to list the tables to vacuum
+   */
+  using TableSource = std::function<void(std::vector<Table> &tables)>;
+
+  explicit VacuumWorker(TableSource table_source, size_t pages_per_round = VACUUM_PAGES_PER_ROUND,
+                        int interval_ms = VACUUM_INTERVAL_MS);
+
+  ~VacuumWorker();
+
+  /**
+   * Keep the worker out while the lock is held
+   */
+  std::shared_lock<std::shared_mutex> Foreground() { return std::shared_lock<std::shared_mutex>(foreground_latch_); }
+
+  /**
+   * Run a round now, waiting for the foreground work to finish
+   * @return the number of pages visited
+   */
+  size_t RunRound();
+
+  /** @return pages visited by all rounds so far */
+  size_t GetVisitedPages() const { return visited_pages_; }
+
+ private:
+  /**
+   * Body of the worker thread
+   */
+  void WorkerLoop();
+
+  /**
+   * Visit up to pages_per_round_ pages, the caller holds foreground_latch_ exclusively
+   */
+  size_t Round();
+
+ private:
+  TableSource table_source_;
+  size_t pages_per_round_;
+  int interval_ms_;
+  size_t next_table_{0};                  // table the next round starts at
+  std::atomic<size_t> visited_pages_{0};  // pages visited by all rounds
+  std::shared_mutex foreground_latch_;    // shared by foreground work, exclusive for a round
+  std::thread worker_;                    // runs a round every interval_ms_
+  std::mutex worker_latch_;               // protects stop_worker_
+  std::condition_variable worker_cv_;     // wakes the worker for shutdown
+  bool stop_worker_{false};               // set to stop the worker
+};
+
+#endif  // MINISQL_VACUUM_WORKER_H
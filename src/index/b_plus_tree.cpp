@@ -15,21 +15,35 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
     : index_id_(index_id),
       buffer_pool_manager_(buffer_pool_manager),
       processor_(KM),
-      leaf_max_size_((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (KM.GetKeySize() + sizeof(RowId) )- 1),
-      internal_max_size_((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (KM.GetKeySize() + sizeof(page_id_t) )- 1) {
+      leaf_max_size_((buffer_pool_manager->GetPageSize() - LEAF_PAGE_HEADER_SIZE) / (KM.GetKeySize() + sizeof(RowId) )- 1),
+      internal_max_size_((buffer_pool_manager->GetPageSize() - INTERNAL_PAGE_HEADER_SIZE) / (KM.GetKeySize() + sizeof(page_id_t) )- 1) {
 
       root_page_id_ = INVALID_PAGE_ID;
+      reservation_.space_id_ = buffer_pool_manager_->GetIndexSpace(index_id);
       auto index_root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
       index_root_page->GetRootId(index_id, &root_page_id_);
       buffer_pool_manager->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
 }
 
+BPlusTree::~BPlusTree() { buffer_pool_manager_->ReleasePages(&reservation_); }
+
 void BPlusTree::Destroy(page_id_t current_page_id) {
   // this function recursively calls itself, and when the upper layer call this fucntion, the current page id is INVALID_PAGE_ID
   if (current_page_id == INVALID_PAGE_ID) { 
+    buffer_pool_manager_->ReleasePages(&reservation_);
     // if there is no root page , just return, no need to delete anything
     if (root_page_id_ == INVALID_PAGE_ID) return;
 
+    // an index with a tablespace of its own goes away with the file, without visiting its pages
+    if (reservation_.space_id_ != 0) {
+      auto index_roots_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+      index_roots_page->Delete(index_id_);
+      buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+      buffer_pool_manager_->DropSpace(reservation_.space_id_);
+      root_page_id_ = INVALID_PAGE_ID;
+      return;
+    }
+
     // get the root page of the bplustree
     auto root_page = buffer_pool_manager_->FetchPage(root_page_id_);
     auto bplus_root_page = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
@@ -37,6 +51,7 @@ void BPlusTree::Destroy(page_id_t current_page_id) {
     // delete the index root in the index roots page
     auto index_roots_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
     index_roots_page->Delete(index_id_);
+    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 
     if (bplus_root_page->IsLeafPage()) { // if there is only a root page, delete it and return
       buffer_pool_manager_->UnpinPage(root_page_id_, false);
@@ -144,7 +159,7 @@ bool BPlusTree::Insert(GenericKey *key, const RowId &value, Txn *transaction) {
  */
 void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
   page_id_t root_page_id;
-  auto root_page = buffer_pool_manager_->NewPage(root_page_id);
+  auto root_page = buffer_pool_manager_->NewPage(root_page_id, &reservation_);
   if (root_page == nullptr) { // if there aren't enough pages 
     throw std::runtime_error("out of memory");
   }
@@ -211,7 +226,7 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Txn *transac
 BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
   page_id_t split_page_id;
   // allocate a new page for the splited page
-  auto split_page = buffer_pool_manager_->NewPage(split_page_id);
+  auto split_page = buffer_pool_manager_->NewPage(split_page_id, &reservation_);
   if (split_page == nullptr) {
     throw std::runtime_error("out of memory");
   }
@@ -224,7 +239,7 @@ BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Txn *transaction) {
 BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
   page_id_t split_page_id;
   // alocate a new page for the splited page, and notice here we do not unpin it (we'll do it in the function that call this)
-  auto split_page = buffer_pool_manager_->NewPage(split_page_id);
+  auto split_page = buffer_pool_manager_->NewPage(split_page_id, &reservation_);
   if (split_page == nullptr) {
     throw std::runtime_error("out of memory");
   }
@@ -246,7 +261,7 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Txn *transaction) {
 void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Txn *transaction) {
   if (old_node->IsRootPage()) { // if the old node is the root, populate a new root
     page_id_t new_root_page_id;
-    auto new_root_page = buffer_pool_manager_->NewPage(new_root_page_id);
+    auto new_root_page = buffer_pool_manager_->NewPage(new_root_page_id, &reservation_);
     // if there are not enough pages to allocate a new root page
     if (new_root_page == nullptr) {
       throw std::runtime_error("out of memory");
@@ -316,11 +331,15 @@ void BPlusTree::Remove(const GenericKey *key, Txn *transaction) {
 
   // record the first value of leaf page
   int64_t old_first_value = bplus_leaf_page->ValueAt(0).Get();
-  GenericKey* old_first_key = new GenericKey;
+  GenericKey* old_first_key = processor_.InitKey();
   memcpy(old_first_key, bplus_leaf_page->KeyAt(0), processor_.GetKeySize());
 
   // if there isn't such a record to be removed, unpin the clean page
-  if (bplus_leaf_page->RemoveAndDeleteRecord(key, processor_) == -1) buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+  if (bplus_leaf_page->RemoveAndDeleteRecord(key, processor_) == -1) {
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+    free(old_first_key);
+    return;
+  }
 
   // check if the removed record is the first value of the leaf page
   if (old_first_value != bplus_leaf_page->ValueAt(0).Get()) { // if true, change the corresponding key in the upper layer
@@ -333,7 +352,7 @@ void BPlusTree::Remove(const GenericKey *key, Txn *transaction) {
       buffer_pool_manager_->UnpinPage(bplus_parent_page->GetPageId(), true);
     }
   }
-
+  free(old_first_key);
 
   // if the size is invalid, amend it
   if (bplus_leaf_page->GetSize() < bplus_leaf_page->GetMinSize()) {
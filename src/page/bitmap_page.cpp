@@ -10,39 +10,23 @@ bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
   // check if the page is full
   if (this->page_allocated_ >= MAX_CHARS * 8) return false;
 
-  // check if the next_free_page_ is valid
-  if (IsPageFree(this->next_free_page_)) {
-    // set the place to be taken
-    SetPageTakenLow(this->next_free_page_ / 8, this->next_free_page_ % 8);
-    // update the page_offset
-    page_offset = this->next_free_page_;
-    
-    // update next_free_page_
-    this->next_free_page_ = (this->next_free_page_ + 1) % (MAX_CHARS * 8);
-    // LOG(INFO) << "Allocate Page " << page_offset << " at " << this->next_free_page_ << "th bit";
-
-    ++(this->page_allocated_);
+  // search word by word, starting at the word of next_free_page_ and wrapping around
+  uint32_t start_word = this->next_free_page_ / 64;
+  for (uint32_t i = 0; i < GetWordCount(); i++) {
+    if (AllocatePageInWord((start_word + i) % GetWordCount(), page_offset)) return true;
   }
-  // if the next_free_page_ is invalid, find the valid next_free_page
-  else {
-    // update next_free_page_
-    FindNextFreePage();
-
-    // LOG(INFO) << "Find Next Free Page " << this->next_free_page_;
-    
-    // set the place to be taken
-    SetPageTakenLow(this->next_free_page_ / 8, this->next_free_page_ % 8);
-
-    // update the page_offset
-    page_offset = this->next_free_page_;
-    
-    // update next_free_page_
-    this->next_free_page_ = (this->next_free_page_ + 1) % (MAX_CHARS * 8);
-
-    ++(this->page_allocated_);
-  }
-  // if (flag) LOG(INFO) <<  "page_al = " << this->page_allocated_ << " MAX_CHAR * 8 = " << MAX_CHARS * 8;
+  return false;
+}
 
+template <size_t PageSize>
+bool BitmapPage<PageSize>::AllocatePageInWord(uint32_t word_index, uint32_t &page_offset, uint64_t candidates) {
+  // the lowest zero bit of the word is the lowest set bit of its complement
+  uint64_t free_pages = ~GetWord(word_index) & candidates;
+  if (free_pages == 0) return false;
+  page_offset = word_index * 64 + __builtin_ctzll(free_pages);
+  SetPageTakenLow(page_offset / 8, page_offset % 8);
+  this->next_free_page_ = (page_offset + 1) % (MAX_CHARS * 8);
+  ++(this->page_allocated_);
   return true;
 }
 
@@ -80,19 +64,6 @@ bool BitmapPage<PageSize>::IsPageFreeLow(uint32_t byte_index, uint8_t bit_index)
   return true;
 }
 
-template <size_t PageSize>
-void BitmapPage<PageSize>::FindNextFreePage() {
-  // find the valid next_free_page
-  while (!IsPageFree(this->next_free_page_)) {
-    this->next_free_page_++;
-
-    // if the next_free_page_ exceeds the MAX_CHARS
-    if (next_free_page_ >= MAX_CHARS * 8) {
-      this->next_free_page_ %= (MAX_CHARS * 8);
-    }
-  }
-}
-
 template <size_t PageSize>
 void BitmapPage<PageSize>::SetPageTakenLow(uint32_t byte_index, uint8_t bit_index) {
   this->bytes[byte_index] |= ('\01' << bit_index);
@@ -110,4 +81,10 @@ template class BitmapPage<1024>;
 
 template class BitmapPage<2048>;
 
-template class BitmapPage<4096>;
\ No newline at end of file
+template class BitmapPage<4096>;
+
+template class BitmapPage<8192>;
+
+template class BitmapPage<16384>;
+
+template class BitmapPage<32768>;
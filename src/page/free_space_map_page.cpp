@@ -0,0 +1,27 @@
+#include "page/free_space_map_page.h"
+
+#include <algorithm>
+
+uint32_t FreeSpaceMapPage::Add(page_id_t page_id, uint8_t category) {
+  uint32_t slot = count_++;
+  page_ids_[slot] = page_id;
+  categories_[slot] = category;
+  return slot;
+}
+
+int FreeSpaceMapPage::FindSlot(uint32_t category) const {
+  for (uint32_t slot = 0; slot < count_; slot++) {
+    if (categories_[slot] >= category) {
+      return slot;
+    }
+  }
+  return -1;
+}
+
+uint8_t FreeSpaceMapPage::GetMaxCategory() const {
+  uint8_t max_category = 0;
+  for (uint32_t slot = 0; slot < count_; slot++) {
+    max_category = std::max(max_category, categories_[slot]);
+  }
+  return max_category;
+}
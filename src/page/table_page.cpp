@@ -1,30 +1,71 @@
 #include "page/table_page.h"
 
+#include <algorithm>
+#include <vector>
+
 // TODO: Update interface implementation if apply recovery
 
 void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Txn *txn) {
   memcpy(GetData(), &page_id, sizeof(page_id));
   SetPrevPageId(prev_id);
   SetNextPageId(INVALID_PAGE_ID);
-  SetFreeSpacePointer(PAGE_SIZE);
+  SetFreeSpaceMapPageId(INVALID_PAGE_ID);
+  SetFreeSpacePointer(GetPageSize());
   SetTupleCount(0);
+  SetFreeSlotHint(0);
+  SetLiveTupleCount(0);
+  memset(GetData() + OFFSET_LIVE_SLOT_BITMAP, 0, GetLiveSlotBitmapSize());
+}
+
+void TablePage::SetLive(uint32_t slot_num, bool live) {
+  char &byte = GetData()[OFFSET_LIVE_SLOT_BITMAP + slot_num / 8];
+  char mask = static_cast<char>(1 << (slot_num % 8));
+  if (static_cast<bool>(byte & mask) == live) {
+    return;
+  }
+  byte = static_cast<char>(live ? byte | mask : byte & ~mask);
+  SetLiveTupleCount(live ? GetLiveTupleCount() + 1 : GetLiveTupleCount() - 1);
+}
+
+uint32_t TablePage::FindSlot(uint32_t slot_num, bool live) {
+  uint32_t tuple_count = GetTupleCount();
+  const char *bitmap = GetData() + OFFSET_LIVE_SLOT_BITMAP;
+  while (slot_num < tuple_count) {
+    // Look at the bits of the slots from slot_num to the end of its 64 slot word at once.
+    uint32_t word_index = slot_num / 64;
+    uint64_t word;
+    memcpy(&word, bitmap + word_index * sizeof(uint64_t), sizeof(uint64_t));
+    if (!live) {
+      word = ~word;
+    }
+    word &= ~uint64_t{0} << (slot_num % 64);
+    if (word != 0) {
+      slot_num = word_index * 64 + __builtin_ctzll(word);
+      break;
+    }
+    slot_num = (word_index + 1) * 64;
+  }
+  return std::min(slot_num, tuple_count);
+}
+
+uint32_t TablePage::FindFreeSlot() {
+  // Free slots are not live, but tombstones marked deleted are not free either.
+  uint32_t slot_num = FindSlot(GetFreeSlotHint(), false);
+  while (slot_num < GetTupleCount() && GetTupleSize(slot_num) != 0) {
+    slot_num = FindSlot(slot_num + 1, false);
+  }
+  SetFreeSlotHint(slot_num);
+  return slot_num;
 }
 
 bool TablePage::InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *lock_manager, LogManager *log_manager) {
   uint32_t serialized_size = row.GetSerializedSize(schema);
   ASSERT(serialized_size > 0, "Can not have empty row.");
-  if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
+  if (GetFreeSpaceRemaining() < serialized_size) {
     return false;
   }
-  // Try to find a free slot to reuse.
-  uint32_t i;
-  for (i = 0; i < GetTupleCount(); i++) {
-    // If the slot is empty, i.e. its tuple has size 0,
-    if (GetTupleSize(i) == 0) {
-      // Then we break out of the loop at index i.
-      break;
-    }
-  }
+  // Try to find a free slot to reuse, otherwise we need room for a new one.
+  uint32_t i = FindFreeSlot();
   if (i == GetTupleCount() && GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
     return false;
   }
@@ -41,6 +82,8 @@ bool TablePage::InsertTuple(Row &row, Schema *schema, Txn *txn, LockManager *loc
   if (i == GetTupleCount()) {
     SetTupleCount(GetTupleCount() + 1);
   }
+  SetLive(i, true);
+  SetFreeSlotHint(i + 1);
   return true;
 }
 
@@ -59,6 +102,7 @@ bool TablePage::MarkDelete(const RowId &rid, Txn *txn, LockManager *lock_manager
   if (tuple_size > 0) {
     SetTupleSize(slot_num, SetDeletedFlag(tuple_size));
   }
+  SetLive(slot_num, false);
   return true;
 }
 
@@ -122,6 +166,8 @@ void TablePage::ApplyDelete(const RowId &rid, Txn *txn, LogManager *log_manager)
   SetFreeSpacePointer(free_space_pointer + tuple_size);
   SetTupleSize(slot_num, 0);
   SetTupleOffsetAtSlot(slot_num, 0);
+  SetLive(slot_num, false);
+  SetFreeSlotHint(std::min(GetFreeSlotHint(), slot_num));
 
   // Update all tuple offsets.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
@@ -140,6 +186,7 @@ void TablePage::RollbackDelete(const RowId &rid, Txn *txn, LogManager *log_manag
   // Unset the deleted flag.
   if (IsDeleted(tuple_size)) {
     SetTupleSize(slot_num, UnsetDeletedFlag(tuple_size));
+    SetLive(slot_num, tuple_size != 0);
   }
 }
 
@@ -164,26 +211,82 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Txn *txn, LockManager *lock_m
   return true;
 }
 
+bool TablePage::GetTupleView(const RowId &rid, Schema *schema, TupleView *view) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || IsDeleted(GetTupleSize(slot_num))) {
+    return false;
+  }
+  view->Reset(GetData() + GetTupleOffsetAtSlot(slot_num), schema, rid);
+  return true;
+}
+
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
   // Find and return the first valid tuple.
-  for (uint32_t i = 0; i < GetTupleCount(); i++) {
-    if (!IsDeleted(GetTupleSize(i))) {
-      first_rid->Set(GetTablePageId(), i);
-      return true;
-    }
+  uint32_t i = GetLiveTupleCount() > 0 ? FindSlot(0, true) : GetTupleCount();
+  if (i < GetTupleCount()) {
+    first_rid->Set(GetTablePageId(), i);
+    return true;
   }
   first_rid->Set(INVALID_PAGE_ID, 0);
   return false;
 }
 
+double TablePage::GetDeadSpaceRatio() {
+  uint32_t dead_bytes = 0;
+  for (uint32_t i = FindSlot(0, false); i < GetTupleCount(); i = FindSlot(i + 1, false)) {
+    dead_bytes += UnsetDeletedFlag(GetTupleSize(i));
+  }
+  return static_cast<double>(dead_bytes) / (GetPageSize() - GetHeaderSize());
+}
+
+bool TablePage::HasRoomFor(uint32_t tuple_bytes, uint32_t tuple_count) {
+  uint32_t free_slots = 0;
+  for (uint32_t i = FindSlot(GetFreeSlotHint(), false); i < GetTupleCount() && free_slots < tuple_count;
+       i = FindSlot(i + 1, false)) {
+    free_slots += GetTupleSize(i) == 0 ? 1 : 0;
+  }
+  return GetFreeSpaceRemaining() >= tuple_bytes + SIZE_TUPLE * (tuple_count - free_slots);
+}
+
+void TablePage::Vacuum(Txn *txn, LogManager *log_manager) {
+  // Drop the deleted tuples, the slots that keep a tuple are packed from the highest offset down.
+  std::vector<uint32_t> slots;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (IsLive(i)) {
+      slots.push_back(i);
+    } else if (GetTupleSize(i) != 0) {
+      SetTupleSize(i, 0);
+      SetTupleOffsetAtSlot(i, 0);
+      SetFreeSlotHint(std::min(GetFreeSlotHint(), i));
+    }
+  }
+  std::sort(slots.begin(), slots.end(),
+            [this](uint32_t a, uint32_t b) { return GetTupleOffsetAtSlot(a) > GetTupleOffsetAtSlot(b); });
+  uint32_t free_space_pointer = GetPageSize();
+  for (uint32_t slot : slots) {
+    // No tuple that is still to move lies above its new place, so moving it up never overwrites one.
+    uint32_t tuple_size = GetTupleSize(slot);
+    free_space_pointer -= tuple_size;
+    memmove(GetData() + free_space_pointer, GetData() + GetTupleOffsetAtSlot(slot), tuple_size);
+    SetTupleOffsetAtSlot(slot, free_space_pointer);
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  // Trailing free slots are not referenced by any rid.
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+  SetFreeSlotHint(std::min(GetFreeSlotHint(), tuple_count));
+}
+
 bool TablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
   ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
   // Find and return the first valid tuple after our current slot number.
-  for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); i++) {
-    if (!IsDeleted(GetTupleSize(i))) {
-      next_rid->Set(GetTablePageId(), i);
-      return true;
-    }
+  uint32_t i = FindSlot(cur_rid.GetSlotNum() + 1, true);
+  if (i < GetTupleCount()) {
+    next_rid->Set(GetTablePageId(), i);
+    return true;
   }
   // Otherwise return false as there are no more tuples.
   next_rid->Set(INVALID_PAGE_ID, 0);
@@ -0,0 +1,73 @@
+#include "record/tuple_view.h"
+
+#include "buffer/buffer_pool_manager.h"
+
+void TupleView::Reset(const char *buf, const Schema *schema, RowId rid) {
+  Release();
+  buf_ = buf;
+  schema_ = schema;
+  rid_ = rid;
+  offsets_.assign(1, 0);
+}
+
+void TupleView::Release() {
+  if (buffer_pool_manager_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(rid_.GetPageId(), false);
+    buffer_pool_manager_ = nullptr;
+  }
+  buf_ = nullptr;
+}
+
+uint32_t TupleView::GetFieldOffset(uint32_t idx) const {
+  ASSERT(idx < schema_->GetColumnCount(), "Failed to access field");
+  // walk from the last field whose offset is known, only char fields need their length read
+  while (offsets_.size() <= idx) {
+    uint32_t i = offsets_.size() - 1;
+    uint32_t offset = offsets_.back();
+    TypeId type = schema_->GetColumn(i)->GetType();
+    if (type == TypeId::kTypeChar) {
+      offset += sizeof(uint32_t) + MACH_READ_UINT32(buf_ + offset);
+    } else {
+      offset += Type::GetTypeSize(type);
+    }
+    offsets_.push_back(offset);
+  }
+  return offsets_[idx];
+}
+
+Field TupleView::GetField(uint32_t idx, bool manage_data) const {
+  ASSERT(IsValid(), "Invalid tuple view.");
+  const char *data = buf_ + GetFieldOffset(idx);
+  TypeId type = schema_->GetColumn(idx)->GetType();
+  switch (type) {
+    case TypeId::kTypeInt:
+      return Field(type, MACH_READ_FROM(int32_t, data));
+    case TypeId::kTypeFloat:
+      return Field(type, MACH_READ_FROM(float_t, data));
+    case TypeId::kTypeChar:
+      return Field(type, const_cast<char *>(data + sizeof(uint32_t)), MACH_READ_UINT32(data), manage_data);
+    default:
+      ASSERT(false, "Unsupported field type.");
+      return Field(type);
+  }
+}
+
+void TupleView::ToRow(Row *row) const {
+  row->destroy();
+  row->SetRowId(rid_);
+  auto &fields = row->GetFields();
+  fields.reserve(GetFieldCount());
+  for (uint32_t i = 0; i < GetFieldCount(); i++) {
+    fields.push_back(new Field(GetField(i, true)));
+  }
+}
+
+void TupleView::ToRow(Row *row, const Schema *output_schema) const {
+  row->destroy();
+  row->SetRowId(rid_);
+  auto &fields = row->GetFields();
+  fields.reserve(output_schema->GetColumnCount());
+  for (auto column : output_schema->GetColumns()) {
+    fields.push_back(new Field(GetField(column->GetTableInd(), true)));
+  }
+}
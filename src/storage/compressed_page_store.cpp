@@ -0,0 +1,185 @@
+#include "storage/compressed_page_store.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+
+#include "glog/logging.h"
+#include "storage/page_codec.h"
+
+namespace {
+/**
+ * @return a buffer of the calling thread large enough for the largest slot
+ */
+char *SlotBuffer(size_t size) {
+  thread_local std::unique_ptr<char[]> buffer(new char[size]);
+  return buffer.get();
+}
+}  // namespace
+
+CompressedPageStore::CompressedPageStore(const std::string &file_name, bool truncate, uint32_t page_size)
+    : page_size_(page_size), slot_sectors_((sizeof(SlotHeader) + page_size + SECTOR_SIZE - 1) / SECTOR_SIZE) {
+  free_slots_.resize(slot_sectors_ + 1);
+  fd_ = open(file_name.c_str(), O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+  if (fd_ < 0) {
+    throw std::runtime_error("Failed to open " + file_name);
+  }
+  LoadSlots();
+}
+
+CompressedPageStore::~CompressedPageStore() {
+  if (fd_ >= 0) close(fd_);
+}
+
+std::string CompressedPageStore::GetFileName(const std::string &db_file) {
+  std::filesystem::path path = db_file;
+  return (path.parent_path() / ("." + path.filename().string() + ".pages")).string();
+}
+
+void CompressedPageStore::LoadSlots() {
+  std::vector<uint64_t> versions;  // version of the slot of every page
+  SlotHeader header;
+  while (pread(fd_, &header, sizeof(header), end_) == sizeof(header)) {
+    if (header.magic_ != SLOT_MAGIC || header.sectors_ == 0 || header.sectors_ > slot_sectors_ ||
+        header.page_id_ < 0 || sizeof(header) + header.data_size_ > header.sectors_ * SECTOR_SIZE) {
+      break;
+    }
+    Slot slot{end_, header.sectors_};
+    end_ += header.sectors_ * SECTOR_SIZE;
+    version_ = std::max(version_, header.version_);
+    if (static_cast<size_t>(header.page_id_) >= slots_.size()) {
+      slots_.resize(header.page_id_ + 1);
+      versions.resize(header.page_id_ + 1);
+    }
+    // of two slots of one page, the one of the later write wins
+    Slot &current = slots_[header.page_id_];
+    if (current.sectors_ != 0 && versions[header.page_id_] > header.version_) {
+      ReleaseSlot(slot);
+      continue;
+    }
+    if (current.sectors_ != 0) {
+      stored_bytes_ -= current.sectors_ * SECTOR_SIZE;
+      ReleaseSlot(current);
+    }
+    current = slot;
+    versions[header.page_id_] = header.version_;
+    stored_bytes_ += slot.sectors_ * SECTOR_SIZE;
+  }
+}
+
+void CompressedPageStore::ReadPage(page_id_t page_id, char *page_data) {
+  Slot slot;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (static_cast<size_t>(page_id) < slots_.size()) slot = slots_[page_id];
+  }
+  if (slot.sectors_ == 0) {
+    memset(page_data, 0, page_size_);
+    return;
+  }
+  char *buffer = SlotBuffer(MAX_SLOT_SECTORS * SECTOR_SIZE);
+  size_t size = slot.sectors_ * SECTOR_SIZE;
+  SlotHeader header;
+  bool valid = pread(fd_, buffer, size, slot.offset_) == static_cast<ssize_t>(size);
+  if (valid) {
+    memcpy(&header, buffer, sizeof(header));
+    valid = header.magic_ == SLOT_MAGIC && header.page_id_ == page_id;
+  }
+  const char *data = buffer + sizeof(header);
+  if (valid && header.compressed_) {
+    valid = PageCodec::Decompress(data, header.data_size_, page_data, page_size_);
+  } else if (valid) {
+    memcpy(page_data, data, page_size_);
+  }
+  if (!valid) {
+    LOG(ERROR) << "Corrupted slot of page " << page_id << " at offset " << slot.offset_;
+    memset(page_data, 0, page_size_);
+  }
+}
+
+void CompressedPageStore::WritePage(page_id_t page_id, const char *page_data) {
+  char *buffer = SlotBuffer(MAX_SLOT_SECTORS * SECTOR_SIZE);
+  SlotHeader header;
+  char *data = buffer + sizeof(header);
+  // only keep the compressed page if it saves a sector
+  size_t capacity = (slot_sectors_ - 1) * SECTOR_SIZE - sizeof(header);
+  size_t data_size = PageCodec::Compress(page_data, page_size_, data, capacity);
+  header.compressed_ = data_size != 0;
+  if (!header.compressed_) {
+    data_size = page_size_;
+    memcpy(data, page_data, page_size_);
+  }
+  header.magic_ = SLOT_MAGIC;
+  header.page_id_ = page_id;
+  header.data_size_ = data_size;
+  header.sectors_ = (sizeof(header) + data_size + SECTOR_SIZE - 1) / SECTOR_SIZE;
+  size_t size = header.sectors_ * SECTOR_SIZE;
+  memset(data + data_size, 0, size - sizeof(header) - data_size);
+
+  Slot old_slot;
+  Slot slot;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (static_cast<size_t>(page_id) >= slots_.size()) slots_.resize(page_id + 1);
+    old_slot = slots_[page_id];
+    // the same number of sectors is rewritten in place
+    slot.sectors_ = header.sectors_;
+    slot.offset_ = old_slot.sectors_ == slot.sectors_ ? old_slot.offset_ : TakeSlot(slot.sectors_);
+    header.version_ = ++version_;
+  }
+  memcpy(buffer, &header, sizeof(header));
+  if (pwrite(fd_, buffer, size, slot.offset_) != static_cast<ssize_t>(size)) {
+    LOG(ERROR) << "I/O error while writing the slot of page " << page_id;
+  }
+  if (old_slot.offset_ == slot.offset_ && old_slot.sectors_ == slot.sectors_) return;
+  // the old slot is only given up once the page is safe in the new one
+  std::scoped_lock<std::mutex> lock(latch_);
+  slots_[page_id] = slot;
+  stored_bytes_ += size;
+  if (old_slot.sectors_ != 0) {
+    stored_bytes_ -= old_slot.sectors_ * SECTOR_SIZE;
+    ReleaseSlot(old_slot);
+  }
+}
+
+void CompressedPageStore::FreePage(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (static_cast<size_t>(page_id) >= slots_.size() || slots_[page_id].sectors_ == 0) return;
+  stored_bytes_ -= slots_[page_id].sectors_ * SECTOR_SIZE;
+  ReleaseSlot(slots_[page_id]);
+  slots_[page_id] = Slot();
+}
+
+void CompressedPageStore::RetainPages(const std::function<bool(page_id_t)> &is_allocated) {
+  for (page_id_t page_id = 0; static_cast<size_t>(page_id) < slots_.size(); page_id++) {
+    if (!is_allocated(page_id)) FreePage(page_id);
+  }
+}
+
+size_t CompressedPageStore::GetFileSize() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return end_;
+}
+
+size_t CompressedPageStore::GetStoredBytes() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return stored_bytes_;
+}
+
+uint64_t CompressedPageStore::TakeSlot(uint32_t sectors) {
+  auto &free_slots = free_slots_[sectors];
+  if (!free_slots.empty()) {
+    uint64_t offset = free_slots.back();
+    free_slots.pop_back();
+    return offset;
+  }
+  uint64_t offset = end_;
+  end_ += sectors * SECTOR_SIZE;
+  return offset;
+}
+
+void CompressedPageStore::ReleaseSlot(const Slot &slot) { free_slots_[slot.sectors_].push_back(slot.offset_); }
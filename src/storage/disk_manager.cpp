@@ -1,22 +1,185 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
+#include <limits.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
 #include <filesystem>
+#include <future>
 #include <stdexcept>
+#include <vector>
 
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, DiskIOType io_type, bool direct_io, bool compress_pages,
+                         bool file_per_table, uint32_t page_size)
+    : io_type_(io_type), file_name_(db_file) {
+  ASSERT(IsValidPageSize(page_size), "Unsupported page size.");
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  // directory does not exist
+  std::filesystem::path p = db_file;
+  if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+  if (io_type_ == DiskIOType::FSTREAM_IO) {
+    OpenStream(db_file);
+  } else {
+    direct_io_ = direct_io;
+    OpenFile(db_file);
+  }
+  if (io_type_ == DiskIOType::IO_URING) {
+    StartIOUring();
+  }
+  // the header of the meta page fits the smallest page, it tells the size of the rest
+  memset(meta_data_, 0, sizeof(meta_data_));
+  ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  bool new_file = meta->GetPageSize() == 0 && meta->GetExtentNums() == 0;
+  if (new_file) {
+    meta->page_size_ = page_size;
+    meta->page_id_size_ = sizeof(page_id_t);
+    meta->compressed_ = compress_pages;
+    meta->file_per_table_ = file_per_table;
+  } else if (!IsValidPageSize(meta->GetPageSize()) || meta->GetPageIdSize() != sizeof(page_id_t)) {
+    LOG(ERROR) << db_file << " has a page size of " << meta->GetPageSize() << " bytes and " << meta->GetPageIdSize()
+               << "-byte page ids, supported are " << MIN_PAGE_SIZE << " to " << MAX_PAGE_SIZE << " bytes and "
+               << sizeof(page_id_t);
+    // nothing has changed, leave the file as it is
+    CloseFile();
+    throw std::runtime_error("Page size mismatch.");
+  }
+  page_size_ = meta->GetPageSize();
+  if (!new_file && page_size_ > MIN_PAGE_SIZE) {
+    ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  }
+  // a bitmap page of page_size_ bytes is the head of the largest one
+  bitmap_size_ = BitmapPage<MAX_PAGE_SIZE>::GetMaxSupportedSize() - (MAX_PAGE_SIZE - page_size_) * 8;
+  extents_per_meta_page_ = DiskFileMetaPage::GetExtentsPerMetaPage(page_size_);
+  max_extents_ = (MAX_VALID_PAGE_ID + 1) / bitmap_size_;
+  LoadExtents();
+  if (meta->IsCompressed()) {
+    // pages left in the store by an earlier file of the same name do not belong to a new file
+    page_store_ =
+        std::make_unique<CompressedPageStore>(CompressedPageStore::GetFileName(db_file), new_file, page_size_);
+    page_store_->RetainPages([this](page_id_t page_id) { return !IsPageFree(page_id); });
+  }
+  if (meta->IsFilePerTable()) {
+    file_per_table_ = true;
+    max_extents_ = SPACE_PAGES / bitmap_size_;
+    LoadSpaces(new_file);
+  }
+}
+
+std::string DiskManager::GetSpaceDirectory(const std::string &db_file) {
+  std::filesystem::path path = db_file;
+  return (path.parent_path() / ("." + path.filename().string() + ".spaces")).string();
+}
+
+void DiskManager::LoadSpaces(bool new_file) {
+  spaces_.resize(MAX_SPACES);
+  std::string directory = GetSpaceDirectory(file_name_);
+  std::error_code ec;
+  if (new_file) {
+    std::filesystem::remove_all(directory, ec);
+    return;
+  }
+  // a tablespace file is named after its id, the slot files of compressed tablespaces are hidden
+  for (const auto &entry : std::filesystem::directory_iterator(directory, ec)) {
+    std::string name = entry.path().filename().string();
+    if (name.empty() || !std::all_of(name.begin(), name.end(), ::isdigit) || name.size() > 3) continue;
+    space_id_t space_id = std::stoul(name);
+    if (space_id == 0 || space_id >= MAX_SPACES) continue;
+    spaces_[space_id] = OpenSpace(space_id);
+  }
+}
+
+std::unique_ptr<DiskManager> DiskManager::OpenSpace(space_id_t space_id) {
+  std::string file_name = GetSpaceDirectory(file_name_) + "/" + std::to_string(space_id);
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  auto space =
+      std::make_unique<DiskManager>(file_name, io_type_, direct_io_, meta->IsCompressed(), false, page_size_);
+  space->max_extents_ = SPACE_PAGES / bitmap_size_;
+  return space;
+}
+
+DiskManager *DiskManager::GetOrCreateSpace(space_id_t space_id, std::shared_lock<std::shared_mutex> *lock) {
+  ASSERT(file_per_table_ && space_id < MAX_SPACES, "Invalid tablespace.");
+  if (spaces_[space_id] == nullptr) {
+    lock->unlock();
+    {
+      std::unique_lock<std::shared_mutex> create_lock(spaces_latch_);
+      if (spaces_[space_id] == nullptr) spaces_[space_id] = OpenSpace(space_id);
+    }
+    lock->lock();
+  }
+  return spaces_[space_id].get();
+}
+
+space_id_t DiskManager::GetTableSpace(table_id_t table_id) const {
+  // tables and indexes take turns, so that neither runs out of tablespace ids before the other
+  uint64_t space_id = uint64_t{table_id} * 2 + 1;
+  return file_per_table_ && space_id < MAX_SPACES ? space_id : 0;
+}
+
+space_id_t DiskManager::GetIndexSpace(index_id_t index_id) const {
+  uint64_t space_id = uint64_t{index_id} * 2 + 2;
+  return file_per_table_ && space_id < MAX_SPACES ? space_id : 0;
+}
+
+void DiskManager::DropSpace(space_id_t space_id) {
+  ASSERT(space_id != 0, "Tablespace 0 is the db file.");
+  std::unique_ptr<DiskManager> space;
+  {
+    std::unique_lock<std::shared_mutex> lock(spaces_latch_);
+    if (!file_per_table_ || spaces_[space_id] == nullptr) return;
+    space = std::move(spaces_[space_id]);
+  }
+  // nothing of a dropped tablespace has to reach the disk
+  space->CloseFile();
+  std::error_code ec;
+  std::filesystem::remove(space->file_name_, ec);
+  std::filesystem::remove(CompressedPageStore::GetFileName(space->file_name_), ec);
+}
+
+bool DiskManager::HasSpace(space_id_t space_id) {
+  std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+  return file_per_table_ && space_id < MAX_SPACES && spaces_[space_id] != nullptr;
+}
+
+void DiskManager::OpenFile(const std::string &db_file) {
+  int flags = O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+  if (direct_io_) {
+    db_fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);
+    // some file systems, e.g. tmpfs, do not support direct I/O
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG(WARNING) << "O_DIRECT is not supported for " << db_file << ", using buffered I/O";
+    }
+  }
+#endif
+  if (db_fd_ < 0) {
+    direct_io_ = false;
+    db_fd_ = open(db_file.c_str(), flags, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw std::exception();
+  }
+  struct stat stat_buf;
+  file_size_ = fstat(db_fd_, &stat_buf) == 0 ? stat_buf.st_size : 0;
+  preallocated_size_ = file_size_;
+}
+
+void DiskManager::OpenStream(const std::string &db_file) {
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
+  // file does not exist
   if (!db_io_.is_open()) {
     db_io_.clear();
     // create a new file
-    std::filesystem::path p = db_file;
-    if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
     db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
     db_io_.close();
     // reopen with original mode
@@ -25,164 +188,865 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
       throw std::exception();
     }
   }
-  ReadPhysicalPage(META_PAGE_ID, meta_data_);
 }
 
 void DiskManager::Close() {
+  {
+    std::unique_lock<std::shared_mutex> spaces_lock(spaces_latch_);
+    spaces_.clear();
+  }
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  WritePhysicalPage(META_PAGE_ID, meta_data_);
   if (!closed) {
+    if (io_type_ == DiskIOType::IO_URING) {
+      StopIOUring();
+    }
+    FlushMetaData();
+    CloseFile();
+  }
+}
+
+void DiskManager::CloseFile() {
+  if (io_type_ == DiskIOType::IO_URING) {
+    StopIOUring();
+  }
+  if (io_type_ == DiskIOType::FSTREAM_IO) {
     db_io_.close();
-    closed = true;
+  } else {
+    close(db_fd_);
   }
+  closed = true;
 }
 
 void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
-  LOG(INFO) << "logical page id = " << logical_page_id;
   ASSERT(logical_page_id >= 0, "Invalid page id.");
-  ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+  if (IsSpacePage(logical_page_id)) {
+    std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+    DiskManager *space = spaces_[GetSpaceId(logical_page_id)].get();
+    // the pages of a dropped tablespace read as zeros
+    if (space == nullptr) {
+      memset(page_data, 0, page_size_);
+    } else {
+      space->ReadPage(GetSpacePageId(logical_page_id), page_data);
+    }
+    return;
+  }
+  if (page_store_ != nullptr) {
+    page_store_->ReadPage(logical_page_id, page_data);
+    return;
+  }
+  // pread does not share a cursor, so only the stream needs the latch
+  if (io_type_ == DiskIOType::FSTREAM_IO) {
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+    ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+  } else if (io_type_ == DiskIOType::IO_URING) {
+    std::promise<void> done;
+    SubmitPageIO(false, MapPageId(logical_page_id), page_data, [&done] { done.set_value(); });
+    done.get_future().wait();
+  } else {
+    ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+  }
 }
 
 void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
-  WritePhysicalPage(MapPageId(logical_page_id), page_data);
+  if (IsSpacePage(logical_page_id)) {
+    std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+    DiskManager *space = spaces_[GetSpaceId(logical_page_id)].get();
+    if (space != nullptr) space->WritePage(GetSpacePageId(logical_page_id), page_data);
+    return;
+  }
+  if (page_store_ != nullptr) {
+    page_store_->WritePage(logical_page_id, page_data);
+    return;
+  }
+  if (io_type_ == DiskIOType::FSTREAM_IO) {
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+    WritePhysicalPage(MapPageId(logical_page_id), page_data);
+  } else if (io_type_ == DiskIOType::IO_URING) {
+    std::promise<void> done;
+    SubmitPageIO(true, MapPageId(logical_page_id), const_cast<char *>(page_data), [&done] { done.set_value(); });
+    done.get_future().wait();
+  } else {
+    WritePhysicalPage(MapPageId(logical_page_id), page_data);
+  }
+}
+
+void DiskManager::ReadPageAsync(page_id_t logical_page_id, char *page_data, IOCallback callback) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  if (IsSpacePage(logical_page_id)) {
+    std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+    DiskManager *space = spaces_[GetSpaceId(logical_page_id)].get();
+    if (space == nullptr) {
+      memset(page_data, 0, page_size_);
+      callback();
+    } else {
+      space->ReadPageAsync(GetSpacePageId(logical_page_id), page_data, std::move(callback));
+    }
+    return;
+  }
+  if (io_type_ != DiskIOType::IO_URING || page_store_ != nullptr) {
+    ReadPage(logical_page_id, page_data);
+    callback();
+    return;
+  }
+  SubmitPageIO(false, MapPageId(logical_page_id), page_data, std::move(callback));
+}
+
+void DiskManager::WritePageAsync(page_id_t logical_page_id, const char *page_data, IOCallback callback) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  if (IsSpacePage(logical_page_id)) {
+    std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+    DiskManager *space = spaces_[GetSpaceId(logical_page_id)].get();
+    if (space == nullptr) {
+      callback();
+    } else {
+      space->WritePageAsync(GetSpacePageId(logical_page_id), page_data, std::move(callback));
+    }
+    return;
+  }
+  if (io_type_ != DiskIOType::IO_URING || page_store_ != nullptr) {
+    WritePage(logical_page_id, page_data);
+    callback();
+    return;
+  }
+  SubmitPageIO(true, MapPageId(logical_page_id), const_cast<char *>(page_data), std::move(callback));
+}
+
+namespace {
+/**
+ * @return the index of the lowest set bit of words, or num_words * 64 if no bit is set
+ */
+size_t FindFirstSet(const uint64_t *words, size_t num_words) {
+  for (size_t i = 0; i < num_words; i++) {
+    if (words[i] != 0) return i * 64 + __builtin_ctzll(words[i]);
+  }
+  return num_words * 64;
+}
+
+void SetBit(uint64_t *words, size_t bit) { words[bit / 64] |= uint64_t{1} << (bit % 64); }
+
+void ClearBit(uint64_t *words, size_t bit) { words[bit / 64] &= ~(uint64_t{1} << (bit % 64)); }
+}  // namespace
+
+page_id_t DiskManager::MetaPhysicalPageId(uint32_t meta_page_index) const {
+  // a meta page followed by extents_per_meta_page_ extents of a bitmap and bitmap_size_ pages each
+  return meta_page_index * (1 + static_cast<page_id_t>(extents_per_meta_page_) * (bitmap_size_ + 1));
+}
+
+page_id_t DiskManager::BitmapPhysicalPageId(uint32_t extent_id) const {
+  return MetaPhysicalPageId(extent_id / extents_per_meta_page_) + 1 +
+         static_cast<page_id_t>(extent_id % extents_per_meta_page_) * (bitmap_size_ + 1);
 }
 
 /**
  * TODO: Student Implement
  */
-page_id_t DiskManager::AllocatePage() {
-  DiskFileMetaPage* meta = reinterpret_cast<DiskFileMetaPage*>(meta_data_);
-  page_id_t physical_bitmap_page_id = INVALID_PAGE_ID, physical_data_page_id = INVALID_PAGE_ID;
-  // find free page_id
-  for (uint32_t extent_index = 0; extent_index < meta->GetExtentNums(); extent_index++) {
-    if (meta->GetExtentUsedPage(extent_index) < BITMAP_SIZE) { // find free bitmap
-      physical_bitmap_page_id = extent_index * (BITMAP_SIZE + 1) + 1; // calculate the physical page id of the bitmap
-
-      // update meta data
-      meta->extent_used_page_[extent_index]++;
-      break;
-    }
-  }
-  if (physical_bitmap_page_id == INVALID_PAGE_ID) {
-    if (meta->GetAllocatedPages() < MAX_VALID_PAGE_ID) {
-      // update meta data
-      meta->num_extents_++;
-      meta->extent_used_page_[meta->GetExtentNums()-1] = 1;
-      physical_bitmap_page_id = (meta->GetExtentNums() - 1) * (BITMAP_SIZE + 1) + 1; // calculate the physical page id of the bitmap
-    }
-    else { // there isn't free page anymore
+page_id_t DiskManager::AllocatePage(space_id_t space_id) {
+  if (space_id != 0) {
+    std::shared_lock<std::shared_mutex> spaces_lock(spaces_latch_);
+    page_id_t space_page_id = GetOrCreateSpace(space_id, &spaces_lock)->AllocatePage();
+    return space_page_id == INVALID_PAGE_ID ? INVALID_PAGE_ID : MakePageId(space_id, space_page_id);
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  // find the first extent with a free page
+  uint32_t extent_id = FindFirstSet(free_extents_.data(), free_extents_.size());
+  if (extent_id >= meta->GetExtentNums()) {
+    if (meta->GetExtentNums() >= max_extents_) {  // there isn't free page anymore
       return INVALID_PAGE_ID;
     }
+    extent_id = meta->GetExtentNums();
+    AddExtent();
   }
-  
-  // read the bitmap and allocate a free page
-  char* bitmap_extent_data = new char[PAGE_SIZE];
-  ReadPhysicalPage(physical_bitmap_page_id, bitmap_extent_data);
-  BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bitmap_extent_data);
-  uint32_t bitmap_page_offset;
-  if (bitmap->AllocatePage(bitmap_page_offset) == false) LOG(INFO) << "FALSE!!!!!!! " << " meta->num_allocated_pages = " << meta->num_allocated_pages_ + 1 << " FALSE!!!!!";
+  // then the first word of its bitmap with a free page
+  uint32_t word_index = FindFirstSet(extents_[extent_id]->free_words_, Extent::SUMMARY_WORDS);
+  page_id_t logical_page_id = AllocatePageInWord(extent_id, word_index);
+  PreallocateFile(MapPageId(logical_page_id));
+  return logical_page_id;
+}
 
-  // rewrite the bitmap page
-  WritePhysicalPage(physical_bitmap_page_id, reinterpret_cast<char*>(bitmap));
+page_id_t DiskManager::AllocatePageInClass(uint32_t num_classes, uint32_t residue, space_id_t space_id) {
+  ASSERT(residue < num_classes, "Invalid page class.");
+  if (space_id != 0) {
+    // the tablespace numbers its pages from 0, shift the class by the id of its first page
+    uint32_t space_residue = (residue + num_classes - MakePageId(space_id, 0) % num_classes) % num_classes;
+    std::shared_lock<std::shared_mutex> spaces_lock(spaces_latch_);
+    page_id_t space_page_id = GetOrCreateSpace(space_id, &spaces_lock)->AllocatePageInClass(num_classes, space_residue);
+    return space_page_id == INVALID_PAGE_ID ? INVALID_PAGE_ID : MakePageId(space_id, space_page_id);
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  // the extents before the first one with a free page are full
+  uint32_t first_extent_id = FindFirstSet(free_extents_.data(), free_extents_.size());
+  for (uint32_t extent_id = std::min(first_extent_id, meta->GetExtentNums());; extent_id++) {
+    if (extent_id == meta->GetExtentNums()) {
+      if (extent_id >= max_extents_) {
+        return INVALID_PAGE_ID;
+      }
+      AddExtent();
+    }
+    if (ExtentUsedPage(extent_id) == bitmap_size_) continue;
+    Extent *extent = extents_[extent_id].get();
+    for (uint32_t word_index = FindFirstSet(extent->free_words_, Extent::SUMMARY_WORDS);
+         word_index < bitmap_size_ / 64; word_index++) {
+      if (!extent->bitmap_.HasFreePage(word_index)) continue;
+      // the pages of the word in the class
+      page_id_t first_page_id = static_cast<page_id_t>(extent_id) * bitmap_size_ + word_index * 64;
+      uint64_t candidates = 0;
+      for (uint32_t bit = (residue + num_classes - first_page_id % num_classes) % num_classes; bit < 64;
+           bit += num_classes) {
+        candidates |= uint64_t{1} << bit;
+      }
+      page_id_t logical_page_id = AllocatePageInWord(extent_id, word_index, candidates);
+      if (logical_page_id != INVALID_PAGE_ID) {
+        PreallocateFile(MapPageId(logical_page_id));
+        return logical_page_id;
+      }
+    }
+  }
+}
+
+page_id_t DiskManager::AllocatePages(size_t count, space_id_t space_id) {
+  ASSERT(count > 0 && count <= 64, "A run of pages must fit one bitmap word.");
+  if (space_id != 0) {
+    std::shared_lock<std::shared_mutex> spaces_lock(spaces_latch_);
+    page_id_t space_page_id = GetOrCreateSpace(space_id, &spaces_lock)->AllocatePages(count);
+    return space_page_id == INVALID_PAGE_ID ? INVALID_PAGE_ID : MakePageId(space_id, space_page_id);
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  // the extents before the first one with a free page are full
+  uint32_t first_extent_id = FindFirstSet(free_extents_.data(), free_extents_.size());
+  for (uint32_t extent_id = std::min(first_extent_id, meta->GetExtentNums());; extent_id++) {
+    if (extent_id == meta->GetExtentNums()) {
+      if (extent_id >= max_extents_) {
+        return INVALID_PAGE_ID;
+      }
+      AddExtent();
+    }
+    if (ExtentUsedPage(extent_id) + count > bitmap_size_) continue;
+    // a word without free pages is skipped through the summary, one with a free page is only taken if all are free
+    Extent *extent = extents_[extent_id].get();
+    for (uint32_t word_index = FindFirstSet(extent->free_words_, Extent::SUMMARY_WORDS);
+         word_index < bitmap_size_ / 64; word_index++) {
+      if (!extent->bitmap_.IsWordFree(word_index)) continue;
+      page_id_t first_page_id = AllocatePageInWord(extent_id, word_index);
+      for (size_t i = 1; i < count; i++) {
+        AllocatePageInWord(extent_id, word_index);
+      }
+      PreallocateFile(MapPageId(first_page_id + count - 1));
+      return first_page_id;
+    }
+  }
+}
 
-  // calculate the physical page id of the data page
-  physical_data_page_id = physical_bitmap_page_id + bitmap_page_offset + 1;
+page_id_t DiskManager::AllocatePageInWord(uint32_t extent_id, uint32_t word_index, uint64_t candidates) {
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  Extent *extent = extents_[extent_id].get();
+  uint32_t bitmap_page_offset;
+  if (!extent->bitmap_.AllocatePageInWord(word_index, bitmap_page_offset, candidates)) {
+    ASSERT(candidates != ~uint64_t{0}, "Extent summary out of sync with its bitmap.");
+    return INVALID_PAGE_ID;
+  }
+  extent->dirty_ = true;
+  if (!extent->bitmap_.HasFreePage(word_index)) {
+    ClearBit(extent->free_words_, word_index);
+  }
 
   // update the meta page
   meta->num_allocated_pages_++;
-  page_id_t logical_page_id = physical_data_page_id - (physical_data_page_id - 1) / (BITMAP_SIZE + 1) - 2; // map physical page id to logical page id
-  return logical_page_id;
+  if (++ExtentUsedPage(extent_id) == bitmap_size_) {
+    ClearBit(free_extents_.data(), extent_id);
+  }
+  return extent_id * bitmap_size_ + bitmap_page_offset;
+}
+
+void DiskManager::PreallocateFile(page_id_t physical_page_id) {
+  size_t end = (static_cast<size_t>(physical_page_id) + 1) * page_size_;
+  if (db_fd_ < 0 || page_store_ != nullptr || end <= preallocated_size_) return;
+  size_t chunk = FILE_GROW_PAGES * page_size_;
+  size_t size = (end + chunk - 1) / chunk * chunk;
+#ifdef FALLOC_FL_KEEP_SIZE
+  // the file size is left alone, reads past the written end still see zeroes; a file system without fallocate
+  // simply allocates on write
+  fallocate(db_fd_, FALLOC_FL_KEEP_SIZE, preallocated_size_, size - preallocated_size_);
+#endif
+  preallocated_size_ = size;
 }
 
 /**
  * TODO: Student Implement
  */
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
+  if (IsSpacePage(logical_page_id)) {
+    std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+    DiskManager *space = spaces_[GetSpaceId(logical_page_id)].get();
+    if (space != nullptr) space->DeAllocatePage(GetSpacePageId(logical_page_id));
+    return;
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (DeAllocatePageBit(logical_page_id)) {
+    freed_pages_.emplace_back(logical_page_id, 1);
+  }
+}
+
+void DiskManager::DeAllocatePages(page_id_t first_page_id, size_t count) {
+  if (IsSpacePage(first_page_id)) {
+    std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+    DiskManager *space = spaces_[GetSpaceId(first_page_id)].get();
+    if (space != nullptr) space->DeAllocatePages(GetSpacePageId(first_page_id), count);
+    return;
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  for (size_t i = 0; i < count; i++) {
+    DeAllocatePageBit(first_page_id + i);
+  }
+  freed_pages_.emplace_back(first_page_id, count);
+}
+
+bool DiskManager::DeAllocatePageBit(page_id_t logical_page_id) {
   if (IsPageFree(logical_page_id)) {
+    return false;
+  }
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  uint32_t extent_id = logical_page_id / bitmap_size_;
+  uint32_t bitmap_page_offset = logical_page_id % bitmap_size_;
+  Extent *extent = extents_[extent_id].get();
+  extent->bitmap_.DeAllocatePage(bitmap_page_offset);
+  extent->dirty_ = true;
+  SetBit(extent->free_words_, bitmap_page_offset / 64);
+  SetBit(free_extents_.data(), extent_id);
+  // update the meta page
+  meta->num_allocated_pages_--;
+  ExtentUsedPage(extent_id)--;
+  if (page_store_ != nullptr) {
+    page_store_->FreePage(logical_page_id);
+  }
+  return true;
+}
+
+void DiskManager::PunchHoles(page_id_t physical_page_id, size_t count) {
+  size_t offset = static_cast<size_t>(physical_page_id) * page_size_;
+  // nothing was written or reserved beyond the end of the file
+  if (!PUNCH_FREED_PAGES || db_fd_ < 0 || page_store_ != nullptr ||
+      offset >= std::max<size_t>(file_size_, preallocated_size_)) {
     return;
   }
-  else {
-    DiskFileMetaPage* meta = reinterpret_cast<DiskFileMetaPage*>(meta_data_);
-    
-    uint32_t bitmap_extent_offset = logical_page_id / BITMAP_SIZE;
-    uint32_t  physical_bitmap_page_id = bitmap_extent_offset * (BITMAP_SIZE + 1) + 1;
-    char* bitmap_extent_data = new char[PAGE_SIZE];
-    ReadPhysicalPage(physical_bitmap_page_id, bitmap_extent_data);
-    BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bitmap_extent_data);
-    uint32_t bitmap_page_offset = logical_page_id % BITMAP_SIZE;
-    bitmap->DeAllocatePage(bitmap_page_offset);
+#ifdef FALLOC_FL_PUNCH_HOLE
+  // a file system without hole punching keeps the pages, which is harmless
+  fallocate(db_fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, count * page_size_);
+#endif
+}
 
-    WritePhysicalPage(physical_bitmap_page_id, reinterpret_cast<char*>(bitmap));
-    // update the meta page
-    meta->num_allocated_pages_--;
-    meta->extent_used_page_[bitmap_extent_offset]--;
-    delete[] bitmap_extent_data;
-    
+void DiskManager::PunchFreedPages() {
+  auto is_free = [this](page_id_t page_id) {
+    uint32_t extent_id = page_id / bitmap_size_;
+    // the extents dropped by Truncate are cut off the file anyway
+    return extent_id < extents_.size() && extents_[extent_id]->bitmap_.IsPageFree(page_id % bitmap_size_);
+  };
+  for (auto [first_page_id, count] : freed_pages_) {
+    for (size_t i = 0; i < count;) {
+      if (!is_free(first_page_id + i)) {
+        i++;
+        continue;
+      }
+      size_t limit = ContiguousRun(first_page_id + i, count - i);
+      size_t run = 1;
+      while (run < limit && is_free(first_page_id + i + run)) run++;
+      PunchHoles(MapPageId(first_page_id + i), run);
+      i += run;
+    }
   }
+  freed_pages_.clear();
+}
+
+page_id_t DiskManager::GetPageEnd(space_id_t space_id) {
+  if (space_id != 0) {
+    std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+    DiskManager *space = file_per_table_ ? spaces_[space_id].get() : nullptr;
+    return space == nullptr ? 0 : space->GetPageEnd();
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  for (uint32_t extent_id = meta->GetExtentNums(); extent_id-- > 0;) {
+    if (ExtentUsedPage(extent_id) == 0) continue;
+    const auto &bitmap = extents_[extent_id]->bitmap_;
+    for (uint32_t word_index = bitmap_size_ / 64; word_index-- > 0;) {
+      if (bitmap.IsWordFree(word_index)) continue;
+      for (uint32_t offset = word_index * 64 + 64; offset-- > word_index * 64;) {
+        if (!bitmap.IsPageFree(offset)) return extent_id * bitmap_size_ + offset + 1;
+      }
+    }
+  }
+  return 0;
+}
+
+void DiskManager::Truncate() {
+  {
+    std::shared_lock<std::shared_mutex> spaces_lock(spaces_latch_);
+    for (auto &space : spaces_) {
+      if (space != nullptr) space->Truncate();
+    }
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  while (meta->GetExtentNums() > 0 && ExtentUsedPage(meta->GetExtentNums() - 1) == 0) {
+    uint32_t extent_id = --meta->num_extents_;
+    ClearBit(free_extents_.data(), extent_id);
+    extents_.pop_back();
+    if (extent_id >= extents_per_meta_page_) GetMetaPage(extent_id)->num_extents_--;
+    // the meta page of a group without extents left ends the chain
+    if (extent_id % extents_per_meta_page_ == 0 && extent_id > 0) {
+      meta_pages_.pop_back();
+      GetMetaPage(extent_id - 1)->next_meta_page_ = 0;
+    }
+    // its meta page is written along with its bitmap
+    if (extent_id > 0) extents_.back()->dirty_ = true;
+  }
+  FlushMetaData();
+  if (db_fd_ < 0) return;
+  // the db file of compressed pages ends with the last bitmap, an uncompressed one with the last allocated page
+  page_id_t end = GetPageEnd();
+  size_t size = page_size_;
+  if (page_store_ != nullptr && meta->GetExtentNums() > 0) {
+    size = (static_cast<size_t>(BitmapPhysicalPageId(meta->GetExtentNums() - 1)) + 1) * page_size_;
+  } else if (page_store_ == nullptr && end > 0) {
+    size = (static_cast<size_t>(MapPageId(end - 1)) + 1) * page_size_;
+  }
+  if (size >= file_size_ && size >= preallocated_size_) return;
+  if (ftruncate(db_fd_, size) != 0) {
+    LOG(ERROR) << "Failed to truncate " << file_name_;
+    return;
+  }
+  file_size_ = size;
+  preallocated_size_ = size;
 }
 
 /**
  * TODO: Student Implement
  */
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
-  uint32_t bitmap_extent_offset = logical_page_id / BITMAP_SIZE;
-  page_id_t physical_bitmap_extent_offset = 1 + bitmap_extent_offset * (BITMAP_SIZE + 1); // calculate the physical page id of the bitmap
-  char* bitmap_extent_data = new char[PAGE_SIZE]; // allocate memory for the bitmap_extent_data
-  ReadPhysicalPage(physical_bitmap_extent_offset, bitmap_extent_data); // read the bitmap_extent_data from the disk
-  BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bitmap_extent_data); // cast the bitmap_extent_data to a BitmapPage 
-  bool is_free = bitmap->IsPageFree(logical_page_id % BITMAP_SIZE); // check if the page is free in the bitmap
-  delete[] bitmap_extent_data;
-  if (is_free) return true;
-  else return false;
+  if (IsSpacePage(logical_page_id)) {
+    std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+    DiskManager *space = spaces_[GetSpaceId(logical_page_id)].get();
+    return space == nullptr || space->IsPageFree(GetSpacePageId(logical_page_id));
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  uint32_t extent_id = logical_page_id / bitmap_size_;
+  if (extent_id >= extents_.size()) return true;
+  return extents_[extent_id]->bitmap_.IsPageFree(logical_page_id % bitmap_size_);
+}
+
+void DiskManager::FlushMetaData() {
+  {
+    std::shared_lock<std::shared_mutex> spaces_lock(spaces_latch_);
+    for (auto &space : spaces_) {
+      if (space != nullptr) space->FlushMetaData();
+    }
+  }
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  // the bitmaps first, the meta pages must not record extents whose bitmap is not on disk
+  std::vector<bool> dirty_meta_pages(meta_pages_.size() + 1);
+  for (uint32_t extent_id = 0; extent_id < extents_.size(); extent_id++) {
+    Extent *extent = extents_[extent_id].get();
+    if (!extent->dirty_) continue;
+    WritePhysicalPage(BitmapPhysicalPageId(extent_id), reinterpret_cast<char *>(&extent->bitmap_));
+    extent->dirty_ = false;
+    dirty_meta_pages[extent_id / extents_per_meta_page_] = true;
+  }
+  // the chained meta pages from the last one, a meta page must not point to one that is not on disk
+  for (uint32_t index = meta_pages_.size(); index > 0; index--) {
+    if (dirty_meta_pages[index]) WritePhysicalPage(MetaPhysicalPageId(index), meta_pages_[index - 1].get());
+  }
+  WritePhysicalPage(META_PAGE_ID, meta_data_);
+  // the freed pages last, the bitmaps on disk no longer point to them
+  PunchFreedPages();
+}
+
+DiskFileMetaPage *DiskManager::GetMetaPage(uint32_t extent_id) {
+  uint32_t index = extent_id / extents_per_meta_page_;
+  return reinterpret_cast<DiskFileMetaPage *>(index == 0 ? meta_data_ : meta_pages_[index - 1].get());
+}
+
+uint32_t &DiskManager::ExtentUsedPage(uint32_t extent_id) {
+  return GetMetaPage(extent_id)->extent_used_page_[extent_id % extents_per_meta_page_];
+}
+
+void DiskManager::LoadExtents() {
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  free_extents_.assign((meta->GetExtentNums() + 63) / 64, 0);
+  for (uint32_t extent_id = 0; extent_id < meta->GetExtentNums(); extent_id++) {
+    if (extent_id % extents_per_meta_page_ == 0 && extent_id > 0) {
+      // follow the chain to the meta page of the next extents
+      page_id_t meta_page_id = GetMetaPage(extent_id - 1)->next_meta_page_;
+      ASSERT(meta_page_id == MetaPhysicalPageId(extent_id / extents_per_meta_page_), "Broken chain of meta pages.");
+      meta_pages_.emplace_back(new char[page_size_]);
+      ReadPhysicalPage(meta_page_id, meta_pages_.back().get());
+    }
+    auto *extent = new Extent();
+    ReadPhysicalPage(BitmapPhysicalPageId(extent_id), reinterpret_cast<char *>(&extent->bitmap_));
+    memset(extent->free_words_, 0, sizeof(extent->free_words_));
+    for (uint32_t word_index = 0; word_index < bitmap_size_ / 64; word_index++) {
+      if (extent->bitmap_.HasFreePage(word_index)) SetBit(extent->free_words_, word_index);
+    }
+    if (ExtentUsedPage(extent_id) < bitmap_size_) SetBit(free_extents_.data(), extent_id);
+    extents_.emplace_back(extent);
+  }
+}
+
+void DiskManager::AddExtent() {
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  auto *extent = new Extent();
+  extent->bitmap_.Reset();
+  memset(extent->free_words_, 0, sizeof(extent->free_words_));
+  for (uint32_t word_index = 0; word_index < bitmap_size_ / 64; word_index++) {
+    SetBit(extent->free_words_, word_index);
+  }
+  extent->dirty_ = true;
+  uint32_t extent_id = meta->GetExtentNums();
+  if (extent_id % extents_per_meta_page_ == 0 && extent_id > 0) {
+    // start the meta page of the next extents and chain it to the one before
+    meta_pages_.emplace_back(new char[page_size_]);
+    memset(meta_pages_.back().get(), 0, page_size_);
+    reinterpret_cast<DiskFileMetaPage *>(meta_pages_.back().get())->page_size_ = page_size_;
+    GetMetaPage(extent_id - 1)->next_meta_page_ = MetaPhysicalPageId(extent_id / extents_per_meta_page_);
+    extents_.back()->dirty_ = true;
+  }
+  if (extent_id / 64 >= free_extents_.size()) free_extents_.push_back(0);
+  SetBit(free_extents_.data(), extent_id);
+  ExtentUsedPage(extent_id) = 0;
+  if (extent_id >= extents_per_meta_page_) GetMetaPage(extent_id)->num_extents_++;
+  meta->num_extents_++;
+  extents_.emplace_back(extent);
+}
+
+void DiskManager::ReadPages(page_id_t first_page_id, size_t count, char *const *page_data) {
+  ASSERT(first_page_id >= 0, "Invalid page id.");
+  if (file_per_table_) {
+    // consecutive page ids may continue in the next tablespace
+    size_t space_left = SPACE_PAGES - GetSpacePageId(first_page_id);
+    if (count > space_left) {
+      ReadPages(first_page_id, space_left, page_data);
+      ReadPages(first_page_id + space_left, count - space_left, page_data + space_left);
+      return;
+    }
+    if (IsSpacePage(first_page_id)) {
+      std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+      DiskManager *space = spaces_[GetSpaceId(first_page_id)].get();
+      for (size_t i = 0; space == nullptr && i < count; i++) {
+        memset(page_data[i], 0, page_size_);
+      }
+      if (space != nullptr) space->ReadPages(GetSpacePageId(first_page_id), count, page_data);
+      return;
+    }
+  }
+  if (io_type_ == DiskIOType::FSTREAM_IO || page_store_ != nullptr) {
+    for (size_t i = 0; i < count; i++) {
+      ReadPage(first_page_id + i, page_data[i]);
+    }
+    return;
+  }
+  for (size_t i = 0, run; i < count; i += run) {
+    run = ContiguousRun(first_page_id + i, count - i);
+    ReadPhysicalPages(MapPageId(first_page_id + i), run, page_data + i);
+  }
+}
+
+void DiskManager::ReadPages(page_id_t first_page_id, size_t count, char *buf) {
+  std::vector<char *> page_data(count);
+  for (size_t i = 0; i < count; i++) {
+    page_data[i] = buf + i * page_size_;
+  }
+  ReadPages(first_page_id, count, page_data.data());
+}
+
+void DiskManager::WritePages(page_id_t first_page_id, size_t count, const char *const *page_data) {
+  ASSERT(first_page_id >= 0, "Invalid page id.");
+  if (file_per_table_) {
+    size_t space_left = SPACE_PAGES - GetSpacePageId(first_page_id);
+    if (count > space_left) {
+      WritePages(first_page_id, space_left, page_data);
+      WritePages(first_page_id + space_left, count - space_left, page_data + space_left);
+      return;
+    }
+    if (IsSpacePage(first_page_id)) {
+      std::shared_lock<std::shared_mutex> lock(spaces_latch_);
+      DiskManager *space = spaces_[GetSpaceId(first_page_id)].get();
+      if (space != nullptr) space->WritePages(GetSpacePageId(first_page_id), count, page_data);
+      return;
+    }
+  }
+  if (io_type_ == DiskIOType::FSTREAM_IO || page_store_ != nullptr) {
+    for (size_t i = 0; i < count; i++) {
+      WritePage(first_page_id + i, page_data[i]);
+    }
+    return;
+  }
+  for (size_t i = 0, run; i < count; i += run) {
+    run = ContiguousRun(first_page_id + i, count - i);
+    WritePhysicalPages(MapPageId(first_page_id + i), run, page_data + i);
+  }
+}
+
+void DiskManager::WritePages(page_id_t first_page_id, size_t count, const char *buf) {
+  std::vector<const char *> page_data(count);
+  for (size_t i = 0; i < count; i++) {
+    page_data[i] = buf + i * page_size_;
+  }
+  WritePages(first_page_id, count, page_data.data());
+}
+
+size_t DiskManager::ContiguousRun(page_id_t logical_page_id, size_t count) {
+  // the bitmap of the next extent separates its pages from the ones of this extent
+  size_t extent_left = bitmap_size_ - logical_page_id % bitmap_size_;
+  return std::min({count, extent_left, static_cast<size_t>(IOV_MAX)});
 }
 
 /**
  * TODO: Student Implement
  */
 page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
-  return 2 + logical_page_id / BITMAP_SIZE + logical_page_id % BITMAP_SIZE + logical_page_id;
+  // skip the meta pages and the bitmaps of this and all earlier extents
+  return BitmapPhysicalPageId(logical_page_id / bitmap_size_) + 1 + logical_page_id % bitmap_size_;
 }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
+int64_t DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
   return rc == 0 ? stat_buf.st_size : -1;
 }
 
+namespace {
+/**
+ * @return an aligned buffer of the calling thread for direct I/O on unaligned page buffers, it holds a page of any size
+ */
+char *BounceBuffer() {
+  struct AlignedPage {
+    AlignedPage() { data_ = static_cast<char *>(aligned_alloc(MIN_PAGE_SIZE, MAX_PAGE_SIZE)); }
+    ~AlignedPage() { free(data_); }
+    char *data_;
+  };
+  thread_local AlignedPage bounce_buffer;
+  return bounce_buffer.data_;
+}
+
+bool IsAligned(const char *page_data) { return reinterpret_cast<uintptr_t>(page_data) % MIN_PAGE_SIZE == 0; }
+}  // namespace
+
 void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+  if (io_type_ == DiskIOType::FSTREAM_IO) {
+    int64_t offset = physical_page_id * page_size_;
+    // check if read beyond file length
+    if (offset >= GetFileSize(file_name_)) {
 #ifdef ENABLE_BPM_DEBUG
-    LOG(INFO) << "Read less than a page" << std::endl;
+      LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-    memset(page_data, 0, PAGE_SIZE);
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+      memset(page_data, 0, page_size_);
+    } else {
+      // set read cursor to offset
+      db_io_.seekp(offset);
+      db_io_.read(page_data, page_size_);
+      // if file ends before reading a whole page
+      size_t read_count = db_io_.gcount();
+      if (read_count < page_size_) {
 #ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
+        LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+        memset(page_data + read_count, 0, page_size_ - read_count);
+      }
     }
+    return;
+  }
+  size_t offset = static_cast<size_t>(physical_page_id) * page_size_;
+  // check if read beyond file length
+  if (offset >= file_size_) {
+    memset(page_data, 0, page_size_);
+    return;
+  }
+  char *buf = direct_io_ && !IsAligned(page_data) ? BounceBuffer() : page_data;
+  ssize_t read_count = pread(db_fd_, buf, page_size_, offset);
+  if (read_count < 0) {
+    LOG(ERROR) << "I/O error while reading";
+    read_count = 0;
+  }
+  // if file ends before reading a whole page
+  if (read_count < page_size_) {
+    memset(buf + read_count, 0, page_size_ - read_count);
+  }
+  if (buf != page_data) {
+    memcpy(page_data, buf, page_size_);
   }
 }
 
 void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  size_t offset = static_cast<size_t>(physical_page_id) * page_size_;
+  if (io_type_ == DiskIOType::FSTREAM_IO) {
+    // set write cursor to offset
+    db_io_.seekp(offset);
+    db_io_.write(page_data, page_size_);
+    // check for I/O error
+    if (db_io_.bad()) {
+      LOG(ERROR) << "I/O error while writing";
+      return;
+    }
+    // needs to flush to keep disk file in sync
+    db_io_.flush();
+    return;
+  }
+  const char *buf = page_data;
+  if (direct_io_ && !IsAligned(page_data)) {
+    buf = static_cast<const char *>(memcpy(BounceBuffer(), page_data, page_size_));
+  }
+  if (pwrite(db_fd_, buf, page_size_, offset) != page_size_) {
+    LOG(ERROR) << "I/O error while writing";
+    return;
+  }
+  GrowFileSize(offset + page_size_);
+}
+
+void DiskManager::ReadPhysicalPages(page_id_t physical_page_id, size_t count, char *const *page_data) {
+  // direct I/O needs aligned buffers, unaligned ones are read one by one through the bounce buffer
+  if (direct_io_ && !std::all_of(page_data, page_data + count, IsAligned)) {
+    for (size_t i = 0; i < count; i++) {
+      ReadPhysicalPage(physical_page_id + i, page_data[i]);
+    }
+    return;
+  }
+  size_t offset = static_cast<size_t>(physical_page_id) * page_size_;
+  std::vector<iovec> iov(count);
+  for (size_t i = 0; i < count; i++) {
+    iov[i] = {page_data[i], page_size_};
+  }
+  ssize_t read_count = 0;
+  // check if read beyond file length
+  if (offset < file_size_) {
+    read_count = preadv(db_fd_, iov.data(), count, offset);
+    if (read_count < 0) {
+      LOG(ERROR) << "I/O error while reading";
+      read_count = 0;
+    }
+  }
+  // pages after the end of the file read as zeros
+  for (size_t i = 0; i < count; i++) {
+    ssize_t page_read = std::clamp<ssize_t>(read_count - static_cast<ssize_t>(i) * page_size_, 0, page_size_);
+    if (page_read < page_size_) {
+      memset(page_data[i] + page_read, 0, page_size_ - page_read);
+    }
+  }
+}
+
+void DiskManager::WritePhysicalPages(page_id_t physical_page_id, size_t count, const char *const *page_data) {
+  if (direct_io_ && !std::all_of(page_data, page_data + count, IsAligned)) {
+    for (size_t i = 0; i < count; i++) {
+      WritePhysicalPage(physical_page_id + i, page_data[i]);
+    }
+    return;
+  }
+  size_t offset = static_cast<size_t>(physical_page_id) * page_size_;
+  std::vector<iovec> iov(count);
+  for (size_t i = 0; i < count; i++) {
+    iov[i] = {const_cast<char *>(page_data[i]), page_size_};
+  }
+  if (pwritev(db_fd_, iov.data(), count, offset) != static_cast<ssize_t>(count * page_size_)) {
     LOG(ERROR) << "I/O error while writing";
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
-}
\ No newline at end of file
+  GrowFileSize(offset + count * page_size_);
+}
+
+void DiskManager::GrowFileSize(size_t end) {
+  // the file only grows, keep the largest end written so far
+  size_t file_size = file_size_;
+  while (file_size < end && !file_size_.compare_exchange_weak(file_size, end)) {
+  }
+}
+
+void DiskManager::StartIOUring() {
+  io_uring_ = std::make_unique<IoUring>(IO_URING_QUEUE_DEPTH);
+  if (!io_uring_->IsOpen()) {
+    LOG(WARNING) << "io_uring is not available, using pread/pwrite for " << file_name_;
+    io_uring_.reset();
+    io_type_ = DiskIOType::PREAD_IO;
+    return;
+  }
+  io_completer_ = std::thread(&DiskManager::CompletionLoop, this);
+}
+
+void DiskManager::StopIOUring() {
+  {
+    std::unique_lock<std::mutex> lock(io_latch_);
+    io_cv_.wait(lock, [this] { return io_in_flight_ == 0; });
+  }
+  // a completion without a page I/O tells the completion thread to stop
+  if (!io_uring_->SubmitNop(0)) {
+    LOG(ERROR) << "Failed to stop the io_uring completion thread";
+    io_completer_.detach();
+  } else {
+    io_completer_.join();
+  }
+  io_uring_.reset();
+  io_type_ = DiskIOType::PREAD_IO;
+}
+
+void DiskManager::SubmitPageIO(bool write, page_id_t physical_page_id, char *page_data, IOCallback callback) {
+  size_t offset = static_cast<size_t>(physical_page_id) * page_size_;
+  // check if read beyond file length, a write to the page that is still in flight does not count
+  if (!write && offset >= file_size_) {
+    memset(page_data, 0, page_size_);
+    callback();
+    return;
+  }
+  auto *io = new PageIO{write, page_data, nullptr, offset, std::move(callback)};
+  if (direct_io_ && !IsAligned(page_data)) {
+    io->bounce_buffer_ = static_cast<char *>(aligned_alloc(MIN_PAGE_SIZE, page_size_));
+    if (write) memcpy(io->bounce_buffer_, page_data, page_size_);
+  }
+  {
+    std::unique_lock<std::mutex> lock(io_latch_);
+    io_cv_.wait(lock, [this] { return io_in_flight_ < static_cast<size_t>(IO_URING_QUEUE_DEPTH); });
+    io_in_flight_++;
+  }
+  char *buf = io->bounce_buffer_ != nullptr ? io->bounce_buffer_ : page_data;
+  if (!io_uring_->Submit(write, db_fd_, buf, page_size_, offset, reinterpret_cast<uint64_t>(io))) {
+    CompletePageIO(io, -EIO);
+  }
+}
+
+void DiskManager::CompletePageIO(PageIO *io, int res) {
+  char *buf = io->bounce_buffer_ != nullptr ? io->bounce_buffer_ : io->page_data_;
+  if (io->write_) {
+    if (res != static_cast<int>(page_size_)) {
+      LOG(ERROR) << "I/O error while writing";
+    } else {
+      GrowFileSize(io->offset_ + page_size_);
+    }
+  } else {
+    if (res < 0) {
+      LOG(ERROR) << "I/O error while reading";
+      res = 0;
+    }
+    // if file ends before reading a whole page
+    if (res < static_cast<int>(page_size_)) {
+      memset(buf + res, 0, page_size_ - res);
+    }
+    if (buf != io->page_data_) {
+      memcpy(io->page_data_, buf, page_size_);
+    }
+  }
+  free(io->bounce_buffer_);
+  io->callback_();
+  delete io;
+  std::scoped_lock<std::mutex> lock(io_latch_);
+  io_in_flight_--;
+  io_cv_.notify_all();
+}
+
+void DiskManager::CompletionLoop() {
+  uint64_t user_data;
+  int res;
+  while (io_uring_->WaitCompletion(&user_data, &res)) {
+    if (user_data == 0) return;
+    CompletePageIO(reinterpret_cast<PageIO *>(user_data), res);
+  }
+  LOG(ERROR) << "io_uring completion thread stopped on an error";
+}
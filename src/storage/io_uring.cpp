@@ -0,0 +1,139 @@
+#include "storage/io_uring.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define MINISQL_HAVE_IO_URING
+#endif
+
+#ifdef MINISQL_HAVE_IO_URING
+namespace {
+int IoUringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+}  // namespace
+
+IoUring::IoUring(unsigned entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IoUringSetup(entries, &params);
+  if (ring_fd < 0) return;  // not supported by the kernel or forbidden by a seccomp filter
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    close(ring_fd);
+    return;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                    IORING_OFF_CQ_RING);
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    if (cq_ring_ != MAP_FAILED && !single_mmap) munmap(cq_ring_, cq_ring_size_);
+    if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+    munmap(sq_ring_, sq_ring_size_);
+    sq_ring_ = cq_ring_ = sqes_ = nullptr;
+    close(ring_fd);
+    return;
+  }
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+  ring_fd_ = ring_fd;
+}
+
+IoUring::~IoUring() {
+  if (!IsOpen()) return;
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+bool IoUring::Submit(bool write, int fd, void *buf, uint32_t len, uint64_t offset, uint64_t user_data) {
+  std::scoped_lock<std::mutex> lock(submit_latch_);
+  return SubmitEntry(write ? IORING_OP_WRITE : IORING_OP_READ, fd, buf, len, offset, user_data);
+}
+
+bool IoUring::SubmitNop(uint64_t user_data) {
+  std::scoped_lock<std::mutex> lock(submit_latch_);
+  return SubmitEntry(IORING_OP_NOP, -1, nullptr, 0, 0, user_data);
+}
+
+bool IoUring::SubmitEntry(uint8_t opcode, int fd, void *buf, uint32_t len, uint64_t offset, uint64_t user_data) {
+  ASSERT(IsOpen(), "io_uring is not set up.");
+  // every entry is submitted right away, so the kernel has consumed all earlier entries and the slot is free
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & sq_mask_;
+  auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buf);
+  sqe->len = len;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  int ret;
+  do {
+    ret = IoUringEnter(ring_fd_, 1, 0, 0);
+  } while (ret < 0 && (errno == EINTR || errno == EAGAIN));
+  if (ret == 1) return true;
+  // the kernel did not take the entry, take it back
+  __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+  return false;
+}
+
+bool IoUring::WaitCompletion(uint64_t *user_data, int *res) {
+  ASSERT(IsOpen(), "io_uring is not set up.");
+  unsigned head = *cq_head_;
+  while (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+    if (IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) return false;
+  }
+  auto *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & cq_mask_);
+  *user_data = cqe->user_data;
+  *res = cqe->res;
+  __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+#else
+IoUring::IoUring(__attribute__((unused)) unsigned entries) {}
+
+IoUring::~IoUring() = default;
+
+bool IoUring::Submit(bool, int, void *, uint32_t, uint64_t, uint64_t) { return false; }
+
+bool IoUring::SubmitNop(uint64_t) { return false; }
+
+bool IoUring::WaitCompletion(uint64_t *, int *) { return false; }
+
+bool IoUring::SubmitEntry(uint8_t, int, void *, uint32_t, uint64_t, uint64_t) { return false; }
+#endif
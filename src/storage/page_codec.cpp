@@ -0,0 +1,143 @@
+#include "storage/page_codec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace {
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;      // the block ends with at least this many literals
+constexpr size_t MATCH_FIND_LIMIT = 12;  // the last match starts at least this many bytes before the end
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 12;
+
+uint32_t Read32(const char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/**
+ * @return bytes needed for a sequence with literal_size literals and a match of match_size bytes beyond MIN_MATCH
+ */
+size_t SequenceSize(size_t literal_size, size_t match_size) {
+  return 1 + (literal_size >= 15 ? (literal_size - 15) / 255 + 1 : 0) + literal_size + 2 +
+         (match_size >= 15 ? (match_size - 15) / 255 + 1 : 0);
+}
+
+/**
+ * Write the part of a length that does not fit the 4 bits of the token
+ */
+char *WriteLength(size_t length, char *op) {
+  for (; length >= 255; length -= 255) {
+    *op++ = static_cast<char>(255);
+  }
+  *op++ = static_cast<char>(length);
+  return op;
+}
+
+/**
+ * Read the part of a length that does not fit the 4 bits of the token
+ * @return false if the block ends within the length
+ */
+bool ReadLength(const uint8_t *&ip, const uint8_t *iend, size_t *length) {
+  uint8_t byte;
+  do {
+    if (ip == iend) return false;
+    byte = *ip++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+}  // namespace
+
+size_t PageCodec::Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) {
+  ASSERT(src_size <= MAX_OFFSET + 1, "Input too large for 2-byte offsets.");
+  const char *ip = src;
+  const char *anchor = src;  // start of the literals not written yet
+  const char *iend = src + src_size;
+  char *op = dst;
+  char *oend = dst + dst_capacity;
+  if (src_size > MATCH_FIND_LIMIT) {
+    const char *mflimit = iend - MATCH_FIND_LIMIT;
+    const char *matchlimit = iend - LAST_LITERALS;
+    uint32_t table[1 << HASH_BITS] = {};  // last position of every hashed 4-byte prefix
+    for (ip++; ip < mflimit;) {
+      uint32_t sequence = Read32(ip);
+      uint32_t h = Hash(sequence);
+      const char *match = src + table[h];
+      table[h] = static_cast<uint32_t>(ip - src);
+      if (match >= ip || static_cast<size_t>(ip - match) > MAX_OFFSET || Read32(match) != sequence) {
+        ip++;
+        continue;
+      }
+      // the match may start earlier than the hashed prefix
+      while (ip > anchor && match > src && ip[-1] == match[-1]) {
+        ip--;
+        match--;
+      }
+      const char *match_end = ip + MIN_MATCH;
+      for (const char *m = match + MIN_MATCH; match_end < matchlimit && *match_end == *m; m++) {
+        match_end++;
+      }
+      size_t literal_size = ip - anchor;
+      size_t match_size = match_end - ip - MIN_MATCH;
+      if (SequenceSize(literal_size, match_size) > static_cast<size_t>(oend - op)) return 0;
+      char *token = op++;
+      *token = static_cast<char>(std::min<size_t>(literal_size, 15) << 4 | std::min<size_t>(match_size, 15));
+      if (literal_size >= 15) op = WriteLength(literal_size - 15, op);
+      memcpy(op, anchor, literal_size);
+      op += literal_size;
+      size_t offset = ip - match;
+      *op++ = static_cast<char>(offset & 0xff);
+      *op++ = static_cast<char>(offset >> 8);
+      if (match_size >= 15) op = WriteLength(match_size - 15, op);
+      ip = anchor = match_end;
+    }
+  }
+  // the last sequence only holds the remaining literals
+  size_t literal_size = iend - anchor;
+  size_t last_size = 1 + (literal_size >= 15 ? (literal_size - 15) / 255 + 1 : 0) + literal_size;
+  if (last_size > static_cast<size_t>(oend - op)) return 0;
+  *op++ = static_cast<char>(std::min<size_t>(literal_size, 15) << 4);
+  if (literal_size >= 15) op = WriteLength(literal_size - 15, op);
+  memcpy(op, anchor, literal_size);
+  op += literal_size;
+  return op - dst;
+}
+
+bool PageCodec::Decompress(const char *src, size_t src_size, char *dst, size_t dst_size) {
+  auto *ip = reinterpret_cast<const uint8_t *>(src);
+  auto *iend = ip + src_size;
+  char *op = dst;
+  char *oend = dst + dst_size;
+  while (ip < iend) {
+    uint8_t token = *ip++;
+    size_t literal_size = token >> 4;
+    if (literal_size == 15 && !ReadLength(ip, iend, &literal_size)) return false;
+    if (literal_size > static_cast<size_t>(iend - ip) || literal_size > static_cast<size_t>(oend - op)) return false;
+    memcpy(op, ip, literal_size);
+    op += literal_size;
+    ip += literal_size;
+    if (ip == iend) break;  // the last sequence has no match
+    if (iend - ip < 2) return false;
+    size_t offset = ip[0] | ip[1] << 8;
+    ip += 2;
+    if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+    size_t match_size = token & 15;
+    if (match_size == 15 && !ReadLength(ip, iend, &match_size)) return false;
+    match_size += MIN_MATCH;
+    if (match_size > static_cast<size_t>(oend - op)) return false;
+    // byte by byte, a match may overlap the bytes it produces
+    const char *match = op - offset;
+    for (size_t i = 0; i < match_size; i++) {
+      op[i] = match[i];
+    }
+    op += match_size;
+  }
+  return op == oend;
+}
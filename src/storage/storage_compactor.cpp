@@ -0,0 +1,227 @@
+#include "storage/storage_compactor.h"
+
+#include <climits>
+#include <cstring>
+
+#include "catalog/catalog.h"
+#include "glog/logging.h"
+#include "page/b_plus_tree_internal_page.h"
+#include "page/b_plus_tree_leaf_page.h"
+#include "page/free_space_map_page.h"
+#include "page/index_roots_page.h"
+#include "page/table_page.h"
+
+dberr_t StorageCompactor::Compact() {
+  if (!buffer_pool_manager_->CheckAllUnpinned()) {
+    LOG(ERROR) << "Cannot compact while pages are pinned.";
+    return DB_FAILED;
+  }
+  CollectPages();
+  FreeUnreachablePages();
+  PlanMoves();
+  if (!moves_.empty()) {
+    RemapReferences();
+  }
+  // the pages are copied on disk, so no frame may hold one of them
+  buffer_pool_manager_->FlushAllPages();
+  buffer_pool_manager_->DiscardPages(0, INT_MAX);
+  MovePages();
+  disk_manager_->Truncate();
+  return DB_SUCCESS;
+}
+
+void StorageCompactor::CollectPages() {
+  live_pages_ = {CATALOG_META_PAGE_ID, INDEX_ROOTS_PAGE_ID};
+  Page *page = buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
+  CatalogMeta *catalog_meta = CatalogMeta::DeserializeFrom(page->GetData());
+  buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, false);
+  for (auto &it : *catalog_meta->GetTableMetaPages()) {
+    table_meta_pages_.insert(it.second);
+    live_pages_.insert(it.second);
+    page = buffer_pool_manager_->FetchPage(it.second);
+    TableMetadata *table_meta = nullptr;
+    TableMetadata::DeserializeFrom(page->GetData(), table_meta);
+    buffer_pool_manager_->UnpinPage(it.second, false);
+    for (page_id_t page_id = table_meta->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+      table_pages_.insert(page_id);
+      live_pages_.insert(page_id);
+      auto table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+      page_id_t next_page_id = table_page->GetNextPageId();
+      page_id_t fsm_page_id = table_page->GetFreeSpaceMapPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      CollectFreeSpaceMapPages(fsm_page_id);
+      page_id = next_page_id;
+    }
+    delete table_meta;
+  }
+  auto index_roots_page =
+      reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  for (auto &it : *catalog_meta->GetIndexMetaPages()) {
+    live_pages_.insert(it.second);
+    index_ids_.push_back(it.first);
+    page_id_t root_page_id = INVALID_PAGE_ID;
+    if (index_roots_page->GetRootId(it.first, &root_page_id) && root_page_id != INVALID_PAGE_ID) {
+      CollectTreePages(root_page_id);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+  delete catalog_meta;
+}
+
+void StorageCompactor::CollectFreeSpaceMapPages(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    fsm_pages_.insert(page_id);
+    live_pages_.insert(page_id);
+    auto free_space_map = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    page_id_t next_page_id = free_space_map->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+void StorageCompactor::CollectTreePages(page_id_t page_id) {
+  tree_pages_.insert(page_id);
+  live_pages_.insert(page_id);
+  auto tree_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  std::vector<page_id_t> children;
+  if (!tree_page->IsLeafPage()) {
+    auto internal_page = reinterpret_cast<BPlusTreeInternalPage *>(tree_page);
+    for (int i = 0; i < internal_page->GetSize(); i++) {
+      children.push_back(internal_page->ValueAt(i));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  for (page_id_t child : children) {
+    CollectTreePages(child);
+  }
+}
+
+void StorageCompactor::FreeUnreachablePages() {
+  for (space_id_t space_id = 0; space_id < DiskManager::MAX_SPACES; space_id++) {
+    if (space_id != 0 && !disk_manager_->HasSpace(space_id)) continue;
+    page_id_t end = disk_manager_->GetPageEnd(space_id);
+    for (page_id_t space_page_id = 0; space_page_id < end; space_page_id++) {
+      page_id_t page_id = DiskManager::MakePageId(space_id, space_page_id);
+      if (live_pages_.count(page_id) == 0 && !disk_manager_->IsPageFree(page_id)) {
+        buffer_pool_manager_->DeletePage(page_id);
+        freed_pages_++;
+      }
+    }
+  }
+}
+
+void StorageCompactor::PlanMoves() {
+  for (space_id_t space_id = 0; space_id < DiskManager::MAX_SPACES; space_id++) {
+    if (space_id != 0 && !disk_manager_->HasSpace(space_id)) continue;
+    page_id_t end = DiskManager::MakePageId(space_id, disk_manager_->GetPageEnd(space_id));
+    // holes ascending and pages descending, a pair only helps while the hole is below the page
+    auto page = live_pages_.lower_bound(end);
+    page_id_t hole = DiskManager::MakePageId(space_id, 0);
+    while (page != live_pages_.begin()) {
+      --page;
+      while (hole < *page && !disk_manager_->IsPageFree(hole)) hole++;
+      if (hole >= *page || SpaceOf(*page) != space_id) break;
+      moves_[*page] = hole;
+      moves_by_target_[hole] = *page;
+      hole++;
+    }
+  }
+}
+
+void StorageCompactor::RemapReferences() {
+  Page *page = buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
+  CatalogMeta *catalog_meta = CatalogMeta::DeserializeFrom(page->GetData());
+  for (auto &it : *catalog_meta->GetTableMetaPages()) {
+    it.second = Remap(it.second);
+  }
+  for (auto &it : *catalog_meta->GetIndexMetaPages()) {
+    it.second = Remap(it.second);
+  }
+  catalog_meta->SerializeTo(page->GetData());
+  buffer_pool_manager_->UnpinPage(CATALOG_META_PAGE_ID, true);
+  delete catalog_meta;
+
+  auto index_roots_page =
+      reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  for (index_id_t index_id : index_ids_) {
+    page_id_t root_page_id = INVALID_PAGE_ID;
+    if (index_roots_page->GetRootId(index_id, &root_page_id)) {
+      index_roots_page->Update(index_id, Remap(root_page_id));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+
+  for (page_id_t page_id : table_meta_pages_) {
+    page = buffer_pool_manager_->FetchPage(page_id);
+    TableMetadata *table_meta = nullptr;
+    TableMetadata::DeserializeFrom(page->GetData(), table_meta);
+    table_meta->SetFirstPageId(Remap(table_meta->GetFirstPageId()));
+    table_meta->SerializeTo(page->GetData());
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    delete table_meta;
+  }
+
+  for (page_id_t page_id : table_pages_) {
+    auto table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    table_page->SetTablePageId(Remap(page_id));
+    table_page->SetPrevPageId(Remap(table_page->GetPrevPageId()));
+    table_page->SetNextPageId(Remap(table_page->GetNextPageId()));
+    table_page->SetFreeSpaceMapPageId(Remap(table_page->GetFreeSpaceMapPageId()));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+
+  for (page_id_t page_id : fsm_pages_) {
+    auto free_space_map = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    free_space_map->SetNextPageId(Remap(free_space_map->GetNextPageId()));
+    for (uint32_t slot = 0; slot < free_space_map->GetCount(); slot++) {
+      free_space_map->SetPageId(slot, Remap(free_space_map->GetPageId(slot)));
+    }
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+
+  for (page_id_t page_id : tree_pages_) {
+    RemapTreePage(page_id);
+  }
+}
+
+void StorageCompactor::RemapTreePage(page_id_t page_id) {
+  auto tree_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  tree_page->SetPageId(Remap(page_id));
+  tree_page->SetParentPageId(Remap(tree_page->GetParentPageId()));
+  if (tree_page->IsLeafPage()) {
+    auto leaf_page = reinterpret_cast<BPlusTreeLeafPage *>(tree_page);
+    leaf_page->SetNextPageId(Remap(leaf_page->GetNextPageId()));
+    for (int i = 0; i < leaf_page->GetSize(); i++) {
+      RowId rid = leaf_page->ValueAt(i);
+      leaf_page->SetValueAt(i, RowId(Remap(rid.GetPageId()), rid.GetSlotNum()));
+    }
+  } else {
+    auto internal_page = reinterpret_cast<BPlusTreeInternalPage *>(tree_page);
+    for (int i = 0; i < internal_page->GetSize(); i++) {
+      internal_page->SetValueAt(i, Remap(internal_page->ValueAt(i)));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+void StorageCompactor::MovePages() {
+  std::vector<char> page_data(disk_manager_->GetPageSize());
+  // in ascending order every target is the lowest free page of its tablespace, the freed pages all lie above it
+  for (auto &it : moves_by_target_) {
+    page_id_t page_id = disk_manager_->AllocatePage(SpaceOf(it.first));
+    ASSERT(page_id == it.first, "The target of a moved page is not the lowest free page.");
+    disk_manager_->ReadPage(it.second, page_data.data());
+    disk_manager_->WritePage(it.first, page_data.data());
+    disk_manager_->DeAllocatePage(it.second);
+    moved_pages_++;
+  }
+}
+
+page_id_t StorageCompactor::Remap(page_id_t page_id) const {
+  auto it = moves_.find(page_id);
+  return it == moves_.end() ? page_id : it->second;
+}
+
+space_id_t StorageCompactor::SpaceOf(page_id_t page_id) const {
+  return disk_manager_->IsFilePerTable() ? DiskManager::GetSpaceId(page_id) : 0;
+}
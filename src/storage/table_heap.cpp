@@ -4,33 +4,68 @@
 /**
  * TODO: Student Implement
  */
-bool TableHeap::InsertTuple(Row &row, Txn *txn) { 
-  page_id_t curPageId = first_page_id_;
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(curPageId));
-  if (page == nullptr) return false; // the buffer pool is full currently
-
-  while (page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_) != true) {
-    buffer_pool_manager_->UnpinPage(curPageId, false);
-    curPageId = page->GetNextPageId();
-    if (curPageId != INVALID_PAGE_ID) { // if there are still pages left, just update the page to the next page
-      page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(curPageId));
-    }
-    else { // if there are no more pages left, create a new page
-      TablePage* newTablePage = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(curPageId));
-      if (curPageId == INVALID_PAGE_ID) return false; // if there are no more free pages, return false
-      newTablePage->Init(curPageId, page->GetPageId(), log_manager_, txn);
-      newTablePage->SetNextPageId(INVALID_PAGE_ID);
-
-      // insert the tuple into the new page
-      newTablePage->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+bool TableHeap::InsertTuple(Row &row, Txn *txn) {
+  uint32_t serialized_size = row.GetSerializedSize(schema_);
+  if (serialized_size > TablePage::GetMaxRowSize(buffer_pool_manager_->GetPageSize())) return false;  // the tuple is too large to fit in any page
+  if (!LoadFreeSpaceMap()) return false;
+  uint32_t category = FreeSpaceMapPage::NeededCategory(serialized_size + TablePage::SIZE_TUPLE,
+                                                       buffer_pool_manager_->GetPageSize());
+  while (true) {
+    page_id_t page_id = FindPageWithSpace(category);
+    bool appended = page_id == INVALID_PAGE_ID;
+    TablePage *page = appended ? AppendPage(page_id, txn)
+                               : reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) return false;  // the buffer pool is full currently
+    bool inserted = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+    // a page whose category promised more room than it has is corrected, so it is not found again
+    UpdateFreeSpace(page_id, page->GetFreeSpaceRemaining());
+    buffer_pool_manager_->UnpinPage(page_id, inserted || appended);
+    if (inserted || appended) return inserted;
+  }
+}
 
-      // set the prev page's next pageId as the new page's pageId
-      page->SetNextPageId(curPageId);
+bool TableHeap::BulkInsert(std::vector<Row> &rows, Txn *txn) {
+  if (rows.empty()) return true;
+  if (!LoadFreeSpaceMap()) return false;
+  page_id_t page_id = last_page_id_;
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) return false;
+  page->WLatch();
+  bool dirty = false;
+  bool inserted = true;
+  for (auto &row : rows) {
+    if (row.GetSerializedSize(schema_) > TablePage::GetMaxRowSize(buffer_pool_manager_->GetPageSize())) {
+      inserted = false;
       break;
     }
+    if (page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
+      dirty = true;
+      continue;
+    }
+    // the page is full, link the next one behind it and let it go
+    page_id_t next_page_id;
+    auto next_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id, &reservation_));
+    if (next_page == nullptr) {
+      inserted = false;
+      break;
+    }
+    next_page->WLatch();
+    next_page->Init(next_page_id, page_id, log_manager_, txn);
+    page->SetNextPageId(next_page_id);
+    UpdateFreeSpace(page_id, page->GetFreeSpaceRemaining());
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    page = next_page;
+    page_id = next_page_id;
+    last_page_id_ = page_id;
+    RegisterPage(page_id, page->GetFreeSpaceRemaining());
+    dirty = true;
+    page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
   }
-  buffer_pool_manager_->UnpinPage(curPageId, true);
-  return true;
+  UpdateFreeSpace(page_id, page->GetFreeSpaceRemaining());
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, dirty);
+  return inserted;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Txn *txn) {
@@ -44,6 +79,7 @@ bool TableHeap::MarkDelete(const RowId &rid, Txn *txn) {
   page->WLatch();
   page->MarkDelete(rid, txn, lock_manager_, log_manager_);
   page->WUnlatch();
+  vacuum_pages_.insert(rid.GetPageId());
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
   return true;
 }
@@ -62,6 +98,7 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
 
   // if the updated row can be fit into the page, return true after update
   if (flag == 1) {
+    UpdateFreeSpace(rid.GetPageId(), page->GetFreeSpaceRemaining());
     buffer_pool_manager_->UnpinPage(rid.GetPageId(), true); 
     return true;
   }
@@ -72,6 +109,8 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Txn *txn) {
   // if the updated row is too large to fit into the page, delete the former row in the page, and insert the updated row into a new page
   else {
     page->ApplyDelete(rid, txn, log_manager_); // delete the former row
+    UpdateFreeSpace(rid.GetPageId(), page->GetFreeSpaceRemaining());
+    vacuum_pages_.insert(rid.GetPageId());
     buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
     if (InsertTuple(targetRow, txn)) return true; // if the insertion is successful
     else return false;  // the insertion is unsuccessful
@@ -91,7 +130,9 @@ void TableHeap::ApplyDelete(const RowId &rid, Txn *txn) {
     return;
   }
   page->ApplyDelete(rid, txn, log_manager_);
+  UpdateFreeSpace(rid.GetPageId(), page->GetFreeSpaceRemaining());
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+  vacuum_pages_.insert(rid.GetPageId());
 
 }
 
@@ -119,6 +160,17 @@ bool TableHeap::GetTuple(Row *row, Txn *txn) {
   else return false;
 }
 
+bool TableHeap::GetTupleView(const RowId &rid, TupleView *view, __attribute__((unused)) Txn *txn, bool bulk_read) {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId(), bulk_read));
+  if (page == nullptr) return false;
+  if (!page->GetTupleView(rid, schema_, view)) {
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    return false;
+  }
+  view->HoldPin(buffer_pool_manager_);
+  return true;
+}
+
 void TableHeap::DeleteTable(page_id_t page_id) {
   if (page_id != INVALID_PAGE_ID) {
     auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  // 删除table_heap
@@ -126,31 +178,263 @@ void TableHeap::DeleteTable(page_id_t page_id) {
       DeleteTable(temp_table_page->GetNextPageId());
     buffer_pool_manager_->UnpinPage(page_id, false);
     buffer_pool_manager_->DeletePage(page_id);
+  } else if (reservation_.space_id_ != 0) {
+    FreeTableHeap();
   } else {
+    DeleteFreeSpaceMap();
     DeleteTable(first_page_id_);
+    buffer_pool_manager_->ReleasePages(&reservation_);
   }
 }
 
 /**
  * TODO: Student Implement
  */
-TableIterator TableHeap::Begin(Txn *txn) {
+TableIterator TableHeap::Begin(Txn *txn, bool bulk_read) {
   if (first_page_id_ == INVALID_PAGE_ID) return End(); // if there wasn't any page, just return a ending iterator
 
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(GetFirstPageId())); // get the first page of the tableheap
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(GetFirstPageId(), bulk_read)); // get the first page of the tableheap
   RowId iteratorRowId;
   while (!page->GetFirstTupleRid(&iteratorRowId)) { // search the table heap until we find the first row or reach the end of the table heap
+    page_id_t next_page_id = page->GetNextPageId();
     buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    if (page->GetNextPageId() != INVALID_PAGE_ID) page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page->GetNextPageId())); 
+    if (next_page_id != INVALID_PAGE_ID) page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id, bulk_read));
     else return TableIterator(nullptr, RowId(INVALID_ROWID), nullptr); // reach the end of the table heap
   }
   buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-  Row row(iteratorRowId);
-  GetTuple(&row, txn);
-  return TableIterator(this, row, txn);
+  return TableIterator(this, iteratorRowId, txn, bulk_read);
 }
 
 /**
  * TODO: Student Implement
  */
 TableIterator TableHeap::End() { return TableIterator(nullptr, RowId(INVALID_ROWID), nullptr); }
+
+void TableHeap::CreateFreeSpaceMap() {
+  page_id_t fsm_page_id;
+  auto fsm_page = buffer_pool_manager_->NewPage(fsm_page_id, &reservation_);
+  ASSERT(fsm_page != nullptr, "There isn't enough page");
+  reinterpret_cast<FreeSpaceMapPage *>(fsm_page->GetData())->Init();
+  fsm_pages_.push_back(fsm_page_id);
+  fsm_max_categories_.push_back(0);
+  buffer_pool_manager_->UnpinPage(fsm_page_id, true);
+}
+
+bool TableHeap::LoadFreeSpaceMap() {
+  if (!fsm_pages_.empty()) return true;
+  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  if (first_page == nullptr) return false;
+  page_id_t fsm_page_id = first_page->GetFreeSpaceMapPageId();
+  buffer_pool_manager_->UnpinPage(first_page_id_, false);
+  ASSERT(fsm_page_id != INVALID_PAGE_ID, "Table heap without a free space map.");
+  std::vector<page_id_t> fsm_pages;
+  std::vector<uint8_t> fsm_max_categories;
+  std::unordered_map<page_id_t, std::pair<uint32_t, uint32_t>> fsm_slots;
+  page_id_t last_page_id = first_page_id_;
+  while (fsm_page_id != INVALID_PAGE_ID) {
+    Page *fsm_page = buffer_pool_manager_->FetchPage(fsm_page_id);
+    if (fsm_page == nullptr) return false;
+    auto free_space_map = reinterpret_cast<FreeSpaceMapPage *>(fsm_page->GetData());
+    for (uint32_t slot = 0; slot < free_space_map->GetCount(); slot++) {
+      if (free_space_map->GetPageId(slot) == INVALID_PAGE_ID) continue;  // removed by the vacuum
+      fsm_slots[free_space_map->GetPageId(slot)] = {fsm_pages.size(), slot};
+      last_page_id = free_space_map->GetPageId(slot);
+    }
+    fsm_pages.push_back(fsm_page_id);
+    fsm_max_categories.push_back(free_space_map->GetMaxCategory());
+    page_id_t next_page_id = free_space_map->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(fsm_page_id, false);
+    fsm_page_id = next_page_id;
+  }
+  // pages are recorded in the order they are appended, so the last one recorded is the last page of the heap
+  fsm_pages_ = std::move(fsm_pages);
+  fsm_max_categories_ = std::move(fsm_max_categories);
+  fsm_slots_ = std::move(fsm_slots);
+  last_page_id_ = last_page_id;
+  return true;
+}
+
+page_id_t TableHeap::FindPageWithSpace(uint32_t category) {
+  for (size_t index = 0; index < fsm_pages_.size(); index++) {
+    if (fsm_max_categories_[index] < category) continue;
+    Page *fsm_page = buffer_pool_manager_->FetchPage(fsm_pages_[index]);
+    if (fsm_page == nullptr) return INVALID_PAGE_ID;
+    auto free_space_map = reinterpret_cast<FreeSpaceMapPage *>(fsm_page->GetData());
+    int slot = free_space_map->FindSlot(category);
+    page_id_t page_id = slot < 0 ? INVALID_PAGE_ID : free_space_map->GetPageId(slot);
+    if (slot < 0) {
+      // the highest category was overestimated, it is only raised in memory when a page gains space
+      fsm_max_categories_[index] = free_space_map->GetMaxCategory();
+    }
+    buffer_pool_manager_->UnpinPage(fsm_pages_[index], false);
+    if (page_id != INVALID_PAGE_ID) return page_id;
+  }
+  return INVALID_PAGE_ID;
+}
+
+void TableHeap::UpdateFreeSpace(page_id_t page_id, uint32_t free_bytes) {
+  if (!LoadFreeSpaceMap()) return;
+  auto it = fsm_slots_.find(page_id);
+  if (it == fsm_slots_.end()) return;
+  auto [index, slot] = it->second;
+  Page *fsm_page = buffer_pool_manager_->FetchPage(fsm_pages_[index]);
+  if (fsm_page == nullptr) return;
+  auto free_space_map = reinterpret_cast<FreeSpaceMapPage *>(fsm_page->GetData());
+  uint8_t category = FreeSpaceMapPage::ToCategory(free_bytes, buffer_pool_manager_->GetPageSize());
+  bool changed = free_space_map->GetCategory(slot) != category;
+  free_space_map->SetCategory(slot, category);
+  fsm_max_categories_[index] = std::max(fsm_max_categories_[index], category);
+  buffer_pool_manager_->UnpinPage(fsm_pages_[index], changed);
+}
+
+void TableHeap::RegisterPage(page_id_t page_id, uint32_t free_bytes) {
+  Page *fsm_page = buffer_pool_manager_->FetchPage(fsm_pages_.back());
+  if (fsm_page == nullptr) return;
+  auto free_space_map = reinterpret_cast<FreeSpaceMapPage *>(fsm_page->GetData());
+  if (free_space_map->IsFull()) {
+    page_id_t fsm_page_id;
+    Page *new_fsm_page = buffer_pool_manager_->NewPage(fsm_page_id, &reservation_);
+    if (new_fsm_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(fsm_pages_.back(), false);
+      return;
+    }
+    free_space_map->SetNextPageId(fsm_page_id);
+    buffer_pool_manager_->UnpinPage(fsm_pages_.back(), true);
+    fsm_pages_.push_back(fsm_page_id);
+    fsm_max_categories_.push_back(0);
+    free_space_map = reinterpret_cast<FreeSpaceMapPage *>(new_fsm_page->GetData());
+    free_space_map->Init();
+  }
+  uint32_t slot = free_space_map->Add(page_id, FreeSpaceMapPage::ToCategory(free_bytes, buffer_pool_manager_->GetPageSize()));
+  fsm_slots_[page_id] = {fsm_pages_.size() - 1, slot};
+  fsm_max_categories_.back() = std::max(fsm_max_categories_.back(), free_space_map->GetCategory(slot));
+  buffer_pool_manager_->UnpinPage(fsm_pages_.back(), true);
+}
+
+TablePage *TableHeap::AppendPage(page_id_t &page_id, Txn *txn) {
+  auto last_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  if (last_page == nullptr) return nullptr;
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(page_id, &reservation_));
+  if (page == nullptr) {  // if there are no more free pages
+    buffer_pool_manager_->UnpinPage(last_page_id_, false);
+    return nullptr;
+  }
+  page->Init(page_id, last_page_id_, log_manager_, txn);
+  last_page->SetNextPageId(page_id);
+  buffer_pool_manager_->UnpinPage(last_page_id_, true);
+  last_page_id_ = page_id;
+  RegisterPage(page_id, page->GetFreeSpaceRemaining());
+  return page;
+}
+
+void TableHeap::DeleteFreeSpaceMap() {
+  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  if (first_page == nullptr) return;
+  page_id_t fsm_page_id = first_page->GetFreeSpaceMapPageId();
+  buffer_pool_manager_->UnpinPage(first_page_id_, false);
+  while (fsm_page_id != INVALID_PAGE_ID) {
+    Page *fsm_page = buffer_pool_manager_->FetchPage(fsm_page_id);
+    if (fsm_page == nullptr) break;
+    page_id_t next_page_id = reinterpret_cast<FreeSpaceMapPage *>(fsm_page->GetData())->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(fsm_page_id, false);
+    buffer_pool_manager_->DeletePage(fsm_page_id);
+    fsm_page_id = next_page_id;
+  }
+  fsm_pages_.clear();
+  fsm_max_categories_.clear();
+  fsm_slots_.clear();
+  vacuum_pages_.clear();
+}
+
+size_t TableHeap::Vacuum(size_t max_pages, const RelocateCallback &on_move) {
+  if (first_page_id_ == INVALID_PAGE_ID || !LoadFreeSpaceMap()) return 0;
+  if (vacuum_all_) {
+    // the deletes from before the heap was opened are not known
+    for (auto &entry : fsm_slots_) {
+      vacuum_pages_.insert(entry.first);
+    }
+    vacuum_all_ = false;
+  }
+  size_t visited = 0;
+  while (visited < max_pages && !vacuum_pages_.empty()) {
+    page_id_t page_id = *vacuum_pages_.begin();
+    vacuum_pages_.erase(vacuum_pages_.begin());
+    if (fsm_slots_.find(page_id) == fsm_slots_.end()) continue;  // merged away meanwhile
+    VacuumPage(page_id, on_move);
+    visited++;
+  }
+  return visited;
+}
+
+void TableHeap::VacuumPage(page_id_t page_id, const RelocateCallback &on_move) {
+  // the bulk read ring keeps the vacuum from pushing the pages of the foreground out of the buffer pool
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, true));
+  if (page == nullptr) return;
+  page->WLatch();
+  bool compacted = page->GetDeadSpaceRatio() >= VACUUM_DEAD_RATIO;
+  if (compacted) {
+    page->Vacuum(nullptr, log_manager_);
+    UpdateFreeSpace(page_id, page->GetFreeSpaceRemaining());
+  }
+  bool merged = page_id != first_page_id_ && page->GetLiveSpaceRatio() <= VACUUM_MERGE_RATIO &&
+                (page->GetLiveTupleCount() == 0 || on_move != nullptr) && MergeIntoPrev(page, on_move);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, compacted);
+  if (merged) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+bool TableHeap::MergeIntoPrev(TablePage *page, const RelocateCallback &on_move) {
+  page_id_t page_id = page->GetTablePageId();
+  page_id_t prev_page_id = page->GetPrevPageId();
+  page_id_t next_page_id = page->GetNextPageId();
+  auto it = fsm_slots_.find(page_id);
+  if (it == fsm_slots_.end()) return false;
+  auto [index, slot] = it->second;
+  // every page that changes is pinned first, so the chain is never left half linked
+  auto prev_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(prev_page_id, true));
+  auto next_page = next_page_id == INVALID_PAGE_ID
+                       ? nullptr
+                       : reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id, true));
+  Page *fsm_page = buffer_pool_manager_->FetchPage(fsm_pages_[index]);
+  bool compacted = false;
+  bool merged = false;
+  if (prev_page != nullptr && (next_page != nullptr || next_page_id == INVALID_PAGE_ID) && fsm_page != nullptr) {
+    prev_page->WLatch();
+    // the previous page may not have been visited yet
+    compacted = prev_page->GetDeadSpaceRatio() >= VACUUM_DEAD_RATIO;
+    if (compacted) {
+      prev_page->Vacuum(nullptr, log_manager_);
+      UpdateFreeSpace(prev_page_id, prev_page->GetFreeSpaceRemaining());
+    }
+    if (prev_page->HasRoomFor(page->GetTupleAreaSize(), page->GetLiveTupleCount())) {
+      RowId rid;
+      for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+        Row row(rid);
+        page->GetTuple(&row, schema_, nullptr, lock_manager_);
+        bool __attribute__((unused)) inserted =
+            prev_page->InsertTuple(row, schema_, nullptr, lock_manager_, log_manager_);
+        ASSERT(inserted, "Tuple does not fit in the previous page.");
+        on_move(row, rid);
+      }
+      prev_page->SetNextPageId(next_page_id);
+      if (next_page != nullptr) {
+        next_page->WLatch();
+        next_page->SetPrevPageId(prev_page_id);
+        next_page->WUnlatch();
+      } else {
+        last_page_id_ = prev_page_id;
+      }
+      reinterpret_cast<FreeSpaceMapPage *>(fsm_page->GetData())->Remove(slot);
+      fsm_slots_.erase(page_id);
+      UpdateFreeSpace(prev_page_id, prev_page->GetFreeSpaceRemaining());
+      merged = true;
+    }
+    prev_page->WUnlatch();
+  }
+  if (prev_page != nullptr) buffer_pool_manager_->UnpinPage(prev_page_id, merged || compacted);
+  if (next_page != nullptr) buffer_pool_manager_->UnpinPage(next_page_id, merged);
+  if (fsm_page != nullptr) buffer_pool_manager_->UnpinPage(fsm_pages_[index], merged);
+  return merged;
+}
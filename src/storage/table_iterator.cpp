@@ -6,19 +6,18 @@
 /**
  * TODO: Student Implement
  */
-TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn) : table_heap(table_heap) {
+TableIterator::TableIterator(TableHeap *table_heap, RowId rid, Txn *txn, bool bulk_read)
+    : table_heap(table_heap), bulk_read_(bulk_read) {
   row = Row(rid);
   // if(!(rid == INVALID_ROWID)) table_heap->GetTuple(&row, txn);
 }
 // personal added function
-TableIterator::TableIterator(TableHeap *table_heap, Row row_, Txn *txn) : table_heap(table_heap) {
+TableIterator::TableIterator(TableHeap *table_heap, Row row_, Txn *txn, bool bulk_read)
+    : table_heap(table_heap), row_loaded_(true), bulk_read_(bulk_read) {
   row = row_;
 }
-TableIterator::TableIterator(const TableIterator &other) {
-  table_heap = new TableHeap(other.table_heap->buffer_pool_manager_, other.table_heap->first_page_id_, other.table_heap->schema_, other.table_heap->log_manager_, other.table_heap->lock_manager_);
-  row = other.row;
-  // txn = new Txn(*other.txn) // not implemented yet
-}
+TableIterator::TableIterator(const TableIterator &other)
+    : table_heap(other.table_heap), row(other.row), row_loaded_(other.row_loaded_), bulk_read_(other.bulk_read_) {}
 
 TableIterator::~TableIterator() {
   // delete[] table_heap;
@@ -33,32 +32,46 @@ bool TableIterator::operator!=(const TableIterator &itr) const {
 }
 
 const Row &TableIterator::operator*() {
+  if (!row_loaded_ && table_heap != nullptr) {
+    table_heap->GetTuple(&row, nullptr);
+    row_loaded_ = true;
+  }
   return row;
-  // else not implemented yet
 }
 
 Row *TableIterator::operator->() {
-  return &row;
+  return const_cast<Row *>(&**this);
+}
+
+bool TableIterator::GetView(TupleView *view) {
+  if (table_heap == nullptr) return false;
+  return table_heap->GetTupleView(row.GetRowId(), view, nullptr, bulk_read_);
 }
 
 TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
   // ASSERT(false, "Not implemented yet.");
   table_heap = itr.table_heap;
   row = itr.row;
+  row_loaded_ = itr.row_loaded_;
+  bulk_read_ = itr.bulk_read_;
+  return *this;
 }
 
 // ++iter
 TableIterator &TableIterator::operator++() {
-  auto page = reinterpret_cast<TablePage *>(table_heap->buffer_pool_manager_->FetchPage(row.GetRowId().GetPageId()));
+  auto page = reinterpret_cast<TablePage *>(
+      table_heap->buffer_pool_manager_->FetchPage(row.GetRowId().GetPageId(), bulk_read_));
   RowId nextRowId;
   if (page->GetNextTupleRid(row.GetRowId(), &nextRowId)) { // if the current page has rows behind the current row, update the rowid
     row.destroy();
     row.SetRowId(nextRowId);
-    table_heap->GetTuple(&row, nullptr);
+    row_loaded_ = false;
+    table_heap->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
   }
   else { // else, check if there are pages behind the current pages
     while (page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto nextPage = reinterpret_cast<TablePage *>(table_heap->buffer_pool_manager_->FetchPage(page->GetNextPageId()));
+      auto nextPage = reinterpret_cast<TablePage *>(
+          table_heap->buffer_pool_manager_->FetchPage(page->GetNextPageId(), bulk_read_));
       table_heap->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
       if (nextPage->GetFirstTupleRid(&nextRowId)) { // scan the rest of the pages until the next row is found
         // table_heap->buffer_pool_manager_->UnpinPage(nextPage->GetPageId(), false);
@@ -68,7 +81,7 @@ TableIterator &TableIterator::operator++() {
         //   return *this;
         row.destroy();
         row.SetRowId(nextRowId);
-        table_heap->GetTuple(&row, nullptr);
+        row_loaded_ = false;
         table_heap->buffer_pool_manager_->UnpinPage(nextPage->GetPageId(), false);
         return *this;
       }
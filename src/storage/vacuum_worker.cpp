@@ -0,0 +1,55 @@
+#include "storage/vacuum_worker.h"
+
+#include <chrono>
+
+VacuumWorker::VacuumWorker(TableSource table_source, size_t pages_per_round, int interval_ms)
+    : table_source_(std::move(table_source)), pages_per_round_(pages_per_round), interval_ms_(interval_ms) {
+  worker_ = std::thread(&VacuumWorker::WorkerLoop, this);
+}
+
+VacuumWorker::~VacuumWorker() {
+  {
+    std::scoped_lock<std::mutex> lock(worker_latch_);
+    stop_worker_ = true;
+  }
+  worker_cv_.notify_one();
+  worker_.join();
+}
+
+size_t VacuumWorker::RunRound() {
+  std::unique_lock<std::shared_mutex> lock(foreground_latch_);
+  return Round();
+}
+
+void VacuumWorker::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(worker_latch_);
+  while (!stop_worker_) {
+    worker_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms_));
+    if (stop_worker_) break;
+    lock.unlock();
+    {
+      // the round is skipped while foreground work is running
+      std::unique_lock<std::shared_mutex> foreground(foreground_latch_, std::try_to_lock);
+      if (foreground.owns_lock()) {
+        Round();
+      }
+    }
+    lock.lock();
+  }
+}
+
+size_t VacuumWorker::Round() {
+  std::vector<Table> tables;
+  table_source_(tables);
+  size_t visited = 0;
+  // every table is tried once, starting from where the last round ran out of pages
+  for (size_t i = 0; i < tables.size() && visited < pages_per_round_; i++) {
+    size_t index = (next_table_ + i) % tables.size();
+    visited += tables[index].table_heap_->Vacuum(pages_per_round_ - visited, tables[index].on_move_);
+    if (visited == pages_per_round_) {
+      next_table_ = index;
+    }
+  }
+  visited_pages_ += visited;
+  return visited;
+}
@@ -1,9 +1,16 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <chrono>
+#include <cinttypes>
 #include <cstdio>
+#include <iostream>
+#include <numeric>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "glog/logging.h"
 TEST(BufferPoolManagerTest, BinaryDataTest) {
@@ -25,19 +32,19 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   ASSERT_NE(nullptr, page0);
   EXPECT_EQ(0, page_id_temp);
 
-  char random_binary_data[PAGE_SIZE];
+  char random_binary_data[DEFAULT_PAGE_SIZE];
   // Generate random binary data
   for (char &i : random_binary_data) {
     i = uniform_dist(rng);
   }
 
   // Insert terminal characters both in the middle and at end
-  random_binary_data[PAGE_SIZE / 2] = '\0';
-  random_binary_data[PAGE_SIZE - 1] = '\0';
+  random_binary_data[DEFAULT_PAGE_SIZE / 2] = '\0';
+  random_binary_data[DEFAULT_PAGE_SIZE - 1] = '\0';
 
   // Scenario: Once we have a page, we should be able to read and write content.
-  std::memcpy(page0->GetData(), random_binary_data, PAGE_SIZE);
-  EXPECT_EQ(0, std::memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+  std::memcpy(page0->GetData(), random_binary_data, DEFAULT_PAGE_SIZE);
+  EXPECT_EQ(0, std::memcmp(page0->GetData(), random_binary_data, DEFAULT_PAGE_SIZE));
 
   // Scenario: We should be able to create new pages until we fill up the buffer pool.
   for (size_t i = 1; i < buffer_pool_size; ++i) {
@@ -61,7 +68,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   }
   // Scenario: We should be able to fetch the data we wrote a while ago.
   page0 = bpm->FetchPage(0, true);
-  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, DEFAULT_PAGE_SIZE));
   EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
   // Shutdown the disk manager and remove the temporary file we created.
@@ -70,4 +77,423 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
-}
\ No newline at end of file
+}
+
+TEST(BufferPoolManagerTest, ScanResistanceTest) {
+  const std::string db_name = "bpm_scan_test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t index_pages = 4;
+  const size_t table_pages = buffer_pool_size * 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, ReplacerType::LRU_K_REPLACER);
+
+  // Pages 0 ~ 3 act as B+ tree pages, the rest as a table heap.
+  page_id_t page_id;
+  for (size_t i = 0; i < index_pages + table_pages; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // Point lookups: every lookup walks from the root page down to a leaf page.
+  for (int lookup = 0; lookup < 8; lookup++) {
+    for (page_id_t index_page = 0; index_page < static_cast<page_id_t>(index_pages); index_page++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(index_page));
+      ASSERT_TRUE(bpm->UnpinPage(index_page, false));
+    }
+  }
+  // Full sequential scan: every table page is fetched once per tuple, one page after another.
+  for (page_id_t table_page = index_pages; table_page < static_cast<page_id_t>(index_pages + table_pages);
+       table_page++) {
+    for (int tuple = 0; tuple < 8; tuple++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(table_page));
+      ASSERT_TRUE(bpm->UnpinPage(table_page, false));
+    }
+  }
+  for (page_id_t index_page = 0; index_page < static_cast<page_id_t>(index_pages); index_page++) {
+    EXPECT_TRUE(bpm->IsPageResident(index_page));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, BulkReadRingTest) {
+  const std::string db_name = "bpm_ring_test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t hot_pages = 32;
+  const size_t table_pages = buffer_pool_size * 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  // plain LRU on its own would let the scan flush every hot page
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, ReplacerType::LRU_REPLACER);
+  bpm->SetDirtyRatioTarget(1.0);  // the flusher's pins would keep the scan from recycling its ring frames
+
+  page_id_t page_id;
+  for (size_t i = 0; i < hot_pages + table_pages; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t hot_page = 0; hot_page < static_cast<page_id_t>(hot_pages); hot_page++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(hot_page));
+    ASSERT_TRUE(bpm->UnpinPage(hot_page, false));
+  }
+  // Sequential scan through the bulk read ring, holding the current page while fetching the next one.
+  page_id_t prev_page = INVALID_PAGE_ID;
+  for (page_id_t table_page = hot_pages; table_page < static_cast<page_id_t>(hot_pages + table_pages); table_page++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(table_page, true));
+    if (prev_page != INVALID_PAGE_ID) {
+      ASSERT_TRUE(bpm->UnpinPage(prev_page, false));
+    }
+    prev_page = table_page;
+  }
+  ASSERT_TRUE(bpm->UnpinPage(prev_page, false));
+  for (page_id_t hot_page = 0; hot_page < static_cast<page_id_t>(hot_pages); hot_page++) {
+    EXPECT_TRUE(bpm->IsPageResident(hot_page));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const std::string db_name = "bpm_concurrent_test.db";
+  const size_t buffer_pool_size = 32;
+  const size_t num_pages = 64;
+  const size_t num_threads = 4;
+  const size_t ops_per_thread = 1 << 13;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), DEFAULT_PAGE_SIZE, "page %" PRId64, page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // Scenario: lock-free hits race with misses that evict pages, every fetch must see the page it asked for.
+  std::vector<std::thread> threads;
+  std::vector<size_t> mismatches(num_threads, 0);
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+      for (size_t i = 0; i < ops_per_thread; i++) {
+        page_id_t target = dist(rng);
+        auto *page = bpm->FetchPage(target);
+        if (page == nullptr) continue;
+        if (page->GetPageId() != target || std::string(page->GetData()) != "page " + std::to_string(target)) {
+          mismatches[t]++;
+        }
+        bpm->UnpinPage(target, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t t = 0; t < num_threads; t++) {
+    EXPECT_EQ(0, mismatches[t]);
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, CrossThreadUnpinTest) {
+  const std::string db_name = "bpm_cross_thread_unpin_test.db";
+  const size_t buffer_pool_size = 2;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_ids[3];
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: a page fetched and unpinned by a thread that then exits can be evicted by another thread.
+  int worker_round_trips = 0;
+  std::thread worker([&] {
+    for (int i = 0; i < 3; i++) {  // a miss, then hits
+      if (bpm->FetchPage(page_ids[0]) == nullptr || !bpm->UnpinPage(page_ids[0], false)) return;
+      worker_round_trips++;
+    }
+  });
+  worker.join();
+  EXPECT_EQ(3, worker_round_trips);
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[2]));
+  page_id_t page_id;
+  auto *page = bpm->NewPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_FALSE(bpm->IsPageResident(page_ids[0]));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[2], false));
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, BackgroundFlusherTest) {
+  const std::string db_name = "bpm_flusher_test.db";
+  const size_t buffer_pool_size = 64;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  bpm->SetDirtyRatioTarget(1.0);
+
+  // Scenario: dirty pages stay in memory while they are within the dirty ratio target.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), DEFAULT_PAGE_SIZE, "page %" PRId64, page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->DirtyPageCount());
+
+  // Scenario: lowering the target makes the flusher write the excess back without any eviction.
+  bpm->SetDirtyRatioTarget(0.25);
+  for (int i = 0; i < 100 && bpm->DirtyPageCount() > buffer_pool_size / 4; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  EXPECT_EQ(buffer_pool_size / 4, bpm->DirtyPageCount());
+  // the pages that became dirty first are written first
+  char data[DEFAULT_PAGE_SIZE];
+  disk_manager->ReadPage(0, data);
+  EXPECT_EQ("page 0", std::string(data));
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    EXPECT_TRUE(bpm->IsPageResident(i));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  const std::string db_name = "bpm_arena_test.db";
+  const size_t buffer_pool_size = 16;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: frame data is page aligned, zeroed and kept apart from the frame descriptors.
+  std::vector<Page *> pages;
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % DEFAULT_PAGE_SIZE);
+    EXPECT_EQ(std::string(DEFAULT_PAGE_SIZE, '\0'), std::string(page->GetData(), DEFAULT_PAGE_SIZE));
+    for (auto *other : pages) {
+      EXPECT_GE(std::abs(page->GetData() - other->GetData()), DEFAULT_PAGE_SIZE);
+      EXPECT_TRUE(reinterpret_cast<char *>(page) < other->GetData() ||
+                  reinterpret_cast<char *>(page) >= other->GetData() + DEFAULT_PAGE_SIZE);
+    }
+    pages.push_back(page);
+  }
+  EXPECT_LT(std::abs(reinterpret_cast<char *>(pages.back()) - reinterpret_cast<char *>(pages.front())),
+            static_cast<ptrdiff_t>(buffer_pool_size * DEFAULT_PAGE_SIZE / 4));
+  for (auto *page : pages) {
+    EXPECT_TRUE(bpm->UnpinPage(page->GetPageId(), false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "bpm_resize_test.db";
+  const size_t buffer_pool_size = 8;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, DEFAULT_REPLACER_TYPE, buffer_pool_size * 2);
+  bpm->SetDirtyRatioTarget(1.0);  // keep the flusher from pinning frames under the test
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), DEFAULT_PAGE_SIZE, "page %" PRId64, page_id);
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size) - 1; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+
+  // Scenario: shrinking drops the unpinned pages of the frames beyond the new size at once, the pinned one later.
+  EXPECT_FALSE(bpm->Resize(0));
+  EXPECT_TRUE(bpm->Resize(buffer_pool_size / 2));
+  EXPECT_EQ(buffer_pool_size / 2, bpm->GetPoolSize());
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    EXPECT_EQ(i < static_cast<page_id_t>(buffer_pool_size / 2) || i == static_cast<page_id_t>(buffer_pool_size - 1),
+              bpm->IsPageResident(i));
+  }
+  EXPECT_TRUE(bpm->UnpinPage(buffer_pool_size - 1, true));
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  size_t resident = 0;
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    resident += bpm->IsPageResident(i) ? 1 : 0;
+  }
+  EXPECT_EQ(buffer_pool_size / 2, resident);
+  for (size_t i = 0; i < buffer_pool_size / 2; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+
+  // Scenario: growing makes room for more pinned pages, up to the maximum the pool was created with.
+  EXPECT_FALSE(bpm->Resize(buffer_pool_size * 2 + 1));
+  EXPECT_TRUE(bpm->Resize(buffer_pool_size * 2));
+  for (size_t i = 0; i < buffer_pool_size * 3 / 2; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, WarmRestartTest) {
+  const std::string db_name = "bpm_warm_restart_test.db";
+  const std::string resident_pages_file = db_name + ".resident";
+  const size_t buffer_pool_size = 8;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, ReplacerType::LRU_REPLACER);
+  bpm->SetDirtyRatioTarget(1.0);  // the flusher's pins would reorder the replacer
+  bpm->SetResidentPagesFile(resident_pages_file);
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size * 2; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // pages 8..15 are resident, 9 is made the hottest
+  ASSERT_NE(nullptr, bpm->FetchPage(9));
+  ASSERT_TRUE(bpm->UnpinPage(9, false));
+  delete bpm;
+
+  // Scenario: a smaller pool preloads the hottest pages of the last shutdown that fit.
+  bpm = new BufferPoolManager(buffer_pool_size / 2, disk_manager);
+  EXPECT_EQ(buffer_pool_size / 2, bpm->PreloadResidentPages(resident_pages_file));
+  std::vector<page_id_t> hottest = {9, 13, 14, 15};
+  for (int i = 0; i < 100; i++) {
+    bool loaded = true;
+    for (auto hot_page : hottest) {
+      loaded = loaded && bpm->IsPageResident(hot_page);
+    }
+    if (loaded) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  for (auto hot_page : hottest) {
+    EXPECT_TRUE(bpm->IsPageResident(hot_page));
+  }
+  // the file is consumed, so a crash does not preload a stale page set
+  EXPECT_EQ(0, bpm->PreloadResidentPages(resident_pages_file));
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "bpm_flush_all_test.db";
+  const size_t buffer_pool_size = 64;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolManager *bpm = new ParallelBufferPoolManager(4, buffer_pool_size / 4, disk_manager);
+  bpm->SetDirtyRatioTarget(1);
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), DEFAULT_PAGE_SIZE, "page %" PRId64, page_id);
+    // a pinned page is flushed as well
+    if (page_id != 5) {
+      ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+  }
+  ASSERT_TRUE(bpm->UnpinPage(5, true));
+  EXPECT_EQ(buffer_pool_size, bpm->DirtyPageCount());
+
+  // Scenario: the consecutive dirty pages of all instances are written back together.
+  bpm->Checkpoint();
+  EXPECT_EQ(0, bpm->DirtyPageCount());
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  char data[DEFAULT_PAGE_SIZE];
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    disk_manager->ReadPage(i, data);
+    EXPECT_EQ("page " + std::to_string(i), std::string(data));
+  }
+  delete bpm;
+
+  // Scenario: consecutive pages are prefetched with vectored reads and can be fetched meanwhile.
+  bpm = new ParallelBufferPoolManager(4, buffer_pool_size / 4, disk_manager);
+  std::vector<page_id_t> page_ids(buffer_pool_size / 2);
+  std::iota(page_ids.begin(), page_ids.end(), 0);
+  bpm->PrefetchPages(page_ids);
+  for (page_id_t i : page_ids) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, FlushAllPagesBenchmark) {
+  const std::string db_name = "bpm_flush_all_bench.db";
+  const size_t buffer_pool_size = 20000;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  bpm->SetDirtyRatioTarget(1);
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    bpm->UnpinPage(page_id, true);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    bpm->FlushPage(i);
+  }
+  auto page_by_page = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  bpm->FlushAllPages();
+  auto vectored = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(0, bpm->DirtyPageCount());
+  std::cout << "flush " << buffer_pool_size << " frames: page by page " << page_by_page << " ms, vectored " << vectored
+            << " ms" << std::endl;
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,47 @@
+#include "buffer/lru_k_replacer.h"
+
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: frames 1 ~ 3 are referenced twice, frames 4 ~ 6 only once.
+  // Back-to-back references to frame 6 are correlated and count once.
+  for (frame_id_t i = 1; i <= 6; i++) {
+    lru_k_replacer.Pin(i);
+    lru_k_replacer.Unpin(i);
+  }
+  lru_k_replacer.Pin(6);
+  lru_k_replacer.Unpin(6);
+  for (frame_id_t i = 1; i <= 3; i++) {
+    lru_k_replacer.Pin(i);
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with a single reference are evicted first, oldest first.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+
+  // Scenario: pinned frames are never victims.
+  lru_k_replacer.Pin(1);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  // Scenario: among hot frames the oldest second-to-last reference goes first.
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: frame 1 becomes victimizable again after it is unpinned.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
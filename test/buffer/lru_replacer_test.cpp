@@ -1,5 +1,9 @@
 #include "buffer/lru_replacer.h"
 
+#include <chrono>
+#include <iostream>
+#include <random>
+
 #include "gtest/gtest.h"
 
 TEST(LRUReplacerTest, SampleTest) {
@@ -40,4 +44,35 @@ TEST(LRUReplacerTest, SampleTest) {
   EXPECT_EQ(6, value);
   lru_replacer.Victim(&value);
   EXPECT_EQ(4, value);
-}
\ No newline at end of file
+}
+
+TEST(LRUReplacerTest, ConstantTimeBenchmark) {
+  const size_t ops = 1 << 20;
+  for (size_t num_pages : {1024, 16384, 131072}) {
+    LRUReplacer lru_replacer(num_pages);
+    for (size_t i = 0; i < num_pages; i++) {
+      lru_replacer.Unpin(i);
+    }
+    std::mt19937 rng(num_pages);
+    std::uniform_int_distribution<frame_id_t> dist(0, num_pages - 1);
+    std::vector<frame_id_t> frames(ops);
+    for (auto &frame : frames) {
+      frame = dist(rng);
+    }
+    auto start = std::chrono::steady_clock::now();
+    frame_id_t victim;
+    for (size_t i = 0; i < ops; i++) {
+      // a hot FetchPage/UnpinPage pair, plus an eviction every few operations
+      lru_replacer.Pin(frames[i]);
+      lru_replacer.Unpin(frames[i]);
+      if ((i & 7) == 0 && lru_replacer.Victim(&victim)) {
+        lru_replacer.Unpin(victim);
+      }
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    // the cost per operation should not grow with the pool size, it is printed rather than asserted on
+    std::cout << "pool size " << num_pages << ": " << elapsed / ops << " ns/op" << std::endl;
+    // every victim was unpinned again, so all frames are still evictable
+    EXPECT_EQ(num_pages, lru_replacer.Size());
+  }
+}
@@ -0,0 +1,78 @@
+#include "buffer/page_table.h"
+
+#include <unordered_map>
+
+#include "gtest/gtest.h"
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(8);
+  frame_id_t frame_id;
+
+  // Scenario: pages map to the frames they were inserted with.
+  for (page_id_t i = 0; i < 8; i++) {
+    page_table.Insert(i * 16, i);
+  }
+  EXPECT_EQ(8, page_table.Size());
+  for (page_id_t i = 0; i < 8; i++) {
+    ASSERT_TRUE(page_table.Find(i * 16, &frame_id));
+    EXPECT_EQ(i, frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(1, &frame_id));
+
+  // Scenario: re-inserting a page replaces its frame.
+  page_table.Insert(0, 7);
+  ASSERT_TRUE(page_table.Find(0, &frame_id));
+  EXPECT_EQ(7, frame_id);
+  EXPECT_EQ(8, page_table.Size());
+
+  // Scenario: erased pages are gone, the others are still found.
+  EXPECT_TRUE(page_table.Erase(32));
+  EXPECT_FALSE(page_table.Erase(32));
+  EXPECT_FALSE(page_table.Find(32, &frame_id));
+  EXPECT_EQ(7, page_table.Size());
+  ASSERT_TRUE(page_table.Find(48, &frame_id));
+  EXPECT_EQ(3, frame_id);
+}
+
+TEST(PageTableTest, ChurnTest) {
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  frame_id_t frame_id;
+
+  // Scenario: keep the table full while replacing pages, as the buffer pool does on eviction.
+  for (page_id_t page_id = 0; page_id < 10000; page_id++) {
+    frame_id_t target = page_id % num_frames;
+    if (page_id >= static_cast<page_id_t>(num_frames)) {
+      ASSERT_TRUE(page_table.Erase(page_id - num_frames));
+      expected.erase(page_id - num_frames);
+    }
+    page_table.Insert(page_id, target);
+    expected[page_id] = target;
+    ASSERT_EQ(expected.size(), page_table.Size());
+  }
+  for (auto &entry : expected) {
+    ASSERT_TRUE(page_table.Find(entry.first, &frame_id));
+    EXPECT_EQ(entry.second, frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(0, &frame_id));
+}
+
+TEST(PageTableTest, ReserveTest) {
+  PageTable page_table(4);
+  frame_id_t frame_id;
+
+  // Scenario: growing the table keeps its pages and makes room for more.
+  for (page_id_t i = 0; i < 4; i++) {
+    page_table.Insert(i, i);
+  }
+  page_table.Reserve(1024);
+  for (page_id_t i = 4; i < 1024; i++) {
+    page_table.Insert(i, i);
+  }
+  EXPECT_EQ(1024, page_table.Size());
+  for (page_id_t i = 0; i < 1024; i++) {
+    ASSERT_TRUE(page_table.Find(i, &frame_id));
+    EXPECT_EQ(i, frame_id);
+  }
+}
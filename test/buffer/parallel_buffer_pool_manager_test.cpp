@@ -0,0 +1,160 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "parallel_bpm_test.db";
+  const size_t num_instances = 4;
+  const size_t pool_size = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolManager *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+
+  // Scenario: new pages are spread over the instances until every frame is pinned.
+  page_id_t page_id;
+  for (size_t i = 0; i < num_instances * pool_size; i++) {
+    auto *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id);
+    snprintf(page->GetData(), DEFAULT_PAGE_SIZE, "page %" PRId64, page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id);
+
+  // Scenario: after unpinning, pages are evicted to disk and read back on fetch.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(num_instances * pool_size); i++) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  for (size_t i = 0; i < num_instances * pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(num_instances * pool_size); i++) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_TRUE(bpm->DeletePage(0));
+  EXPECT_TRUE(bpm->IsPageFree(0));
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(ParallelBufferPoolManagerTest, RoundRobinTest) {
+  const std::string db_name = "parallel_bpm_round_robin_test.db";
+  const size_t num_instances = 4;
+  const size_t pool_size = 4;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolManager *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+  page_id_t page_id;
+  for (size_t i = 0; i < num_instances * pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: the lowest free page ids all belong to instance 0, new pages still go to every instance in turn.
+  for (page_id_t i : {0, 4, 8}) {
+    EXPECT_TRUE(bpm->DeletePage(i));
+  }
+  std::vector<bool> instances_used(num_instances, false);
+  for (size_t i = 0; i < num_instances; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_FALSE(instances_used[page_id % num_instances]);
+    instances_used[page_id % num_instances] = true;
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: an instance with every frame pinned is skipped.
+  std::vector<page_id_t> pinned;
+  for (page_id_t i = 0; i < static_cast<page_id_t>(num_instances * pool_size); i += num_instances) {
+    if (bpm->IsPageFree(i)) continue;
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    pinned.push_back(i);
+  }
+  while (pinned.size() < pool_size) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    if (page_id % num_instances == 0) {
+      pinned.push_back(page_id);
+    } else {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  for (size_t i = 0; i < 2 * num_instances; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_NE(0, page_id % num_instances);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t i : pinned) {
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(ParallelBufferPoolManagerTest, ThroughputBenchmark) {
+  const std::string db_name = "parallel_bpm_bench.db";
+  const size_t num_pages = 256;
+  const size_t ops_per_thread = 1 << 15;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  for (size_t num_instances : {1, 8}) {
+    BufferPoolManager *bpm = new ParallelBufferPoolManager(num_instances, num_pages, disk_manager);
+    page_id_t page_id;
+    for (size_t i = 0; i < num_pages; i++) {
+      ASSERT_NE(nullptr, bpm->NewPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+    for (size_t num_threads : {1, 2, 4, 8}) {
+      std::atomic<size_t> hits{0};
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+          std::mt19937 rng(t);
+          std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+          size_t local_hits = 0;
+          for (size_t i = 0; i < ops_per_thread; i++) {
+            page_id_t target = dist(rng);
+            if (bpm->FetchPage(target) != nullptr) {
+              local_hits++;
+              bpm->UnpinPage(target, false);
+            }
+          }
+          hits += local_hits;
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      EXPECT_EQ(num_threads * ops_per_thread, hits.load());
+      std::cout << num_instances << " instance(s), " << num_threads
+                << " thread(s): fetch/unpin throughput " << hits.load() / elapsed << " ops/s" << std::endl;
+    }
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    delete bpm;
+  }
+  delete disk_manager;
+  remove(db_name.c_str());
+}
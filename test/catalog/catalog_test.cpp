@@ -1,5 +1,7 @@
 #include "catalog/catalog.h"
 
+#include <filesystem>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "utils/utils.h"
@@ -7,7 +9,7 @@
 static string db_file_name = "catalog_test.db";
 
 TEST(CatalogTest, CatalogMetaTest) {
-  char *buf = new char[PAGE_SIZE];
+  char *buf = new char[DEFAULT_PAGE_SIZE];
   CatalogMeta *meta = CatalogMeta::NewInstance();
   // fill data
   const int table_nums = 16;
@@ -126,4 +128,114 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
   delete db_02;
-}
\ No newline at end of file
+}
+
+TEST(CatalogTest, FilePerTableTest) {
+  std::string space_dir = DiskManager::GetSpaceDirectory("./databases/" + db_file_name);
+  auto db_01 = new DBStorageEngine(db_file_name, true, DEFAULT_BUFFER_POOL_SIZE, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Txn txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_info));
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info, "bptree"));
+  space_id_t table_space = db_01->bpm_->GetTableSpace(table_info->GetTableId());
+  // the first index of a new database
+  space_id_t index_space = db_01->bpm_->GetIndexSpace(0);
+  ASSERT_NE(0, table_space);
+  ASSERT_NE(0, index_space);
+  const int row_nums = 1000;
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+    std::vector<Field> key_fields{Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key, row.GetRowId(), &txn));
+  }
+  // the pages of the table and the index live in their tablespace files
+  EXPECT_EQ(table_space, DiskManager::GetSpaceId(table_info->GetTableHeap()->GetFirstPageId()));
+  EXPECT_TRUE(std::filesystem::exists(space_dir + "/" + std::to_string(table_space)));
+  EXPECT_TRUE(std::filesystem::exists(space_dir + "/" + std::to_string(index_space)));
+  delete db_01;
+
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("table-1", table_info));
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("table-1", "index-1", index_info));
+  int row_count = 0;
+  for (auto it = table_info->GetTableHeap()->Begin(&txn); it != table_info->GetTableHeap()->End(); ++it) {
+    row_count++;
+  }
+  EXPECT_EQ(row_nums, row_count);
+  std::vector<RowId> result;
+  std::vector<Field> key_fields{Field(TypeId::kTypeInt, row_nums / 2)};
+  Row key(key_fields);
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn));
+  ASSERT_EQ(1, result.size());
+  // dropping the index and the table removes their files
+  ASSERT_EQ(DB_SUCCESS, catalog_02->DropIndex("table-1", "index-1"));
+  EXPECT_FALSE(std::filesystem::exists(space_dir + "/" + std::to_string(index_space)));
+  EXPECT_TRUE(std::filesystem::exists(space_dir + "/" + std::to_string(table_space)));
+  ASSERT_EQ(DB_SUCCESS, catalog_02->DropTable("table-1"));
+  EXPECT_FALSE(std::filesystem::exists(space_dir + "/" + std::to_string(table_space)));
+  delete db_02;
+}
+
+TEST(CatalogTest, VacuumTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 200, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Txn txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_info));
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info, "bptree"));
+  const int row_nums = 2000;
+  std::string name(200, 'x');
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), 200, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+    std::vector<Field> key_fields{Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key, row.GetRowId(), &txn));
+    rids.push_back(row.GetRowId());
+  }
+  // delete nine in ten rows the way the delete executor does
+  for (int i = 0; i < row_nums; i++) {
+    if (i % 10 == 0) continue;
+    ASSERT_TRUE(table_info->GetTableHeap()->MarkDelete(rids[i], &txn));
+    std::vector<Field> key_fields{Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->RemoveEntry(key, rids[i], &txn));
+  }
+  // Scenario: the rows the vacuum moves to merge pages are still found through the index.
+  db_01->StartVacuum();
+  size_t moved = 0;
+  while (db_01->vacuum_worker_->RunRound() > 0) {
+  }
+  for (int i = 0; i < row_nums; i += 10) {
+    std::vector<RowId> result;
+    std::vector<Field> key_fields{Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn));
+    ASSERT_EQ(1, result.size());
+    Row row(result[0]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, &txn));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    moved += result[0] == rids[i] ? 0 : 1;
+  }
+  EXPECT_GT(moved, 0);
+  delete db_01;
+}
@@ -1,6 +1,10 @@
 //
 // Created by njz on 2023/1/26.
 //
+#include <chrono>
+
+#include "executor/executors/insert_executor.h"
+#include "executor/executors/values_executor.h"
 #include "executor/plans/delete_plan.h"
 #include "executor/plans/insert_plan.h"
 #include "executor/plans/seq_scan_plan.h"
@@ -154,3 +158,59 @@ TEST_F(ExecutorTest, SimpleUpdateTest) {
     ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("minisql"), 7, false)));
   }
 }
+
+// INSERT INTO table-1 VALUES (0, "..."), (1, "..."), ... against TableHeap::BulkInsert into table-2
+TEST(InsertExecutorTest, BulkInsertBenchmark) {
+  const int row_nums = 20000;
+  const std::string db_name = "bulk_insert_bench.db";
+  auto db = new DBStorageEngine(db_name, true);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableInfo *table_infos[2];
+  ASSERT_EQ(DB_SUCCESS, db->catalog_mgr_->CreateTable("table-1", schema.get(), nullptr, table_infos[0]));
+  ASSERT_EQ(DB_SUCCESS, db->catalog_mgr_->CreateTable("table-2", schema.get(), nullptr, table_infos[1]));
+  std::string name(64, 'x');
+  std::vector<std::vector<AbstractExpressionRef>> raw_values;
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<Field> fields{Field(kTypeInt, i), Field(kTypeChar, const_cast<char *>(name.c_str()), 64, false)};
+    raw_values.push_back(
+        {std::make_shared<ConstantValueExpression>(fields[0]), std::make_shared<ConstantValueExpression>(fields[1])});
+    rows.emplace_back(fields);
+  }
+  auto exec_ctx = db->MakeExecuteContext(nullptr);
+  auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+  auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+
+  // Scenario: the same rows loaded row by row through the insert executor and in one bulk insert.
+  InsertExecutor executor(exec_ctx.get(), insert_plan.get(),
+                          std::make_unique<ValuesExecutor>(exec_ctx.get(), value_plan.get()));
+  auto start = std::chrono::steady_clock::now();
+  executor.Init();
+  Row row;
+  RowId rid;
+  int inserted = 0;
+  while (executor.Next(&row, &rid)) {
+    inserted++;
+  }
+  auto executor_elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_EQ(row_nums, inserted);
+  start = std::chrono::steady_clock::now();
+  ASSERT_TRUE(table_infos[1]->GetTableHeap()->BulkInsert(rows, nullptr));
+  auto bulk_elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "insert executor: " << executor_elapsed << " ms, bulk insert: " << bulk_elapsed << " ms for " << row_nums
+            << " rows" << std::endl;
+  for (auto table_info : table_infos) {
+    int rows_read = 0;
+    for (auto it = table_info->GetTableHeap()->Begin(nullptr); it != table_info->GetTableHeap()->End(); it++) {
+      ASSERT_EQ(CmpBool::kTrue, it->GetField(0)->CompareEquals(Field(kTypeInt, rows_read)));
+      rows_read++;
+    }
+    EXPECT_EQ(row_nums, rows_read);
+  }
+  delete db;
+  // other executor tests open every database they find
+  remove(("./databases/" + db_name).c_str());
+  remove(("./databases/." + db_name + ".resident").c_str());
+}
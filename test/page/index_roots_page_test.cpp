@@ -5,8 +5,8 @@
 #include "gtest/gtest.h"
 
 TEST(PageTests, IndexRootsPageTest) {
-  char *buf = new char[PAGE_SIZE];
-  memset(buf, 0, PAGE_SIZE);
+  char *buf = new char[DEFAULT_PAGE_SIZE];
+  memset(buf, 0, DEFAULT_PAGE_SIZE);
   auto *page = reinterpret_cast<IndexRootsPage *>(buf);
   page->Init();
   for (int i = 0; i < 25; i++) {
@@ -0,0 +1,86 @@
+#include "page/table_page.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "record/field.h"
+#include "record/schema.h"
+
+TEST(PageTests, TablePageSlotTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  Schema schema(columns);
+  TablePage page;
+  page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  RowId rid;
+  ASSERT_FALSE(page.GetFirstTupleRid(&rid));
+  // fill the page with small rows
+  uint32_t slots = 0;
+  while (true) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, static_cast<int32_t>(slots))};
+    Row row(fields);
+    if (!page.InsertTuple(row, &schema, nullptr, nullptr, nullptr)) {
+      break;
+    }
+    ASSERT_EQ(slots, row.GetRowId().GetSlotNum());
+    slots++;
+  }
+  ASSERT_GT(slots, 128);
+  ASSERT_EQ(slots, page.GetLiveTupleCount());
+  // delete every tuple but the last one, only half of the deletes are applied
+  for (uint32_t i = 0; i + 1 < slots; i++) {
+    ASSERT_TRUE(page.MarkDelete(RowId(0, i), nullptr, nullptr, nullptr));
+    if (i % 2 == 0) {
+      page.ApplyDelete(RowId(0, i), nullptr, nullptr);
+    }
+  }
+  ASSERT_FALSE(page.MarkDelete(RowId(0, 1), nullptr, nullptr, nullptr));
+  ASSERT_EQ(1, page.GetLiveTupleCount());
+  ASSERT_TRUE(page.GetFirstTupleRid(&rid));
+  ASSERT_EQ(slots - 1, rid.GetSlotNum());
+  ASSERT_FALSE(page.GetNextTupleRid(rid, &rid));
+  // a rolled back delete makes its tuple visible again
+  page.RollbackDelete(RowId(0, 1), nullptr, nullptr);
+  ASSERT_EQ(2, page.GetLiveTupleCount());
+  ASSERT_TRUE(page.GetFirstTupleRid(&rid));
+  ASSERT_EQ(1, rid.GetSlotNum());
+  ASSERT_TRUE(page.GetNextTupleRid(rid, &rid));
+  ASSERT_EQ(slots - 1, rid.GetSlotNum());
+  // inserts reuse the freed slots in order, skipping the tombstones
+  for (uint32_t i = 0; i + 1 < slots; i += 2) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, static_cast<int32_t>(i))};
+    Row row(fields);
+    ASSERT_TRUE(page.InsertTuple(row, &schema, nullptr, nullptr, nullptr));
+    ASSERT_EQ(i, row.GetRowId().GetSlotNum());
+  }
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 0)};
+  Row row(fields);
+  ASSERT_FALSE(page.InsertTuple(row, &schema, nullptr, nullptr, nullptr));
+  // a slot freed below the free slot hint is found again
+  page.MarkDelete(RowId(0, 4), nullptr, nullptr, nullptr);
+  page.ApplyDelete(RowId(0, 4), nullptr, nullptr);
+  ASSERT_TRUE(page.InsertTuple(row, &schema, nullptr, nullptr, nullptr));
+  ASSERT_EQ(4, row.GetRowId().GetSlotNum());
+  Row read(RowId(0, 4));
+  ASSERT_TRUE(page.GetTuple(&read, &schema, nullptr, nullptr));
+  ASSERT_EQ(CmpBool::kTrue, read.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 0)));
+  // vacuuming reclaims the tombstones and the free slots at the end, the tuple left keeps its rid
+  for (uint32_t i = 0; i < slots; i++) {
+    if (i != 4) {
+      page.MarkDelete(RowId(0, i), nullptr, nullptr, nullptr);
+    }
+  }
+  ASSERT_GT(page.GetDeadSpaceRatio(), 0.2);
+  page.Vacuum(nullptr, nullptr);
+  ASSERT_EQ(0, page.GetDeadSpaceRatio());
+  ASSERT_EQ(1, page.GetLiveTupleCount());
+  ASSERT_EQ(read.GetSerializedSize(&schema), page.GetTupleAreaSize());
+  ASSERT_TRUE(page.GetFirstTupleRid(&rid));
+  ASSERT_EQ(4, rid.GetSlotNum());
+  read.destroy();
+  ASSERT_TRUE(page.GetTuple(&read, &schema, nullptr, nullptr));
+  ASSERT_EQ(CmpBool::kTrue, read.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, 0)));
+  for (uint32_t slot : {0, 1, 2, 3, 5}) {
+    ASSERT_TRUE(page.InsertTuple(row, &schema, nullptr, nullptr, nullptr));
+    ASSERT_EQ(slot, row.GetRowId().GetSlotNum());
+  }
+}
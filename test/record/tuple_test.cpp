@@ -3,9 +3,14 @@
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "page/table_page.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
 #include "record/field.h"
 #include "record/row.h"
 #include "record/schema.h"
+#include "record/tuple_view.h"
 
 char *chars[] = {const_cast<char *>(""), const_cast<char *>("hello"), const_cast<char *>("world!"),
                  const_cast<char *>("\0")};
@@ -27,7 +32,7 @@ Field char_fields[] = {Field(TypeId::kTypeChar, chars[0], strlen(chars[0]), fals
 Field null_fields[] = {Field(TypeId::kTypeInt), Field(TypeId::kTypeFloat), Field(TypeId::kTypeChar)};
 
 TEST(TupleTest, FieldSerializeDeserializeTest) {
-  char buffer[PAGE_SIZE];
+  char buffer[DEFAULT_PAGE_SIZE];
   memset(buffer, 0, sizeof(buffer));
   // Serialize phase
   char *p = buffer;
@@ -100,4 +105,72 @@ TEST(TupleTest, RowTest) {
   }
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
-}
\ No newline at end of file
+}
+
+TEST(TupleTest, TupleViewTest) {
+  TablePage table_page;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188),
+                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+                               Field(TypeId::kTypeFloat, 19.99f)};
+  auto schema = std::make_shared<Schema>(columns);
+  Row row(fields);
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  TupleView view;
+  ASSERT_FALSE(table_page.GetTupleView(RowId(0, 1), schema.get(), &view));
+  ASSERT_TRUE(table_page.GetTupleView(row.GetRowId(), schema.get(), &view));
+  ASSERT_EQ(row.GetRowId(), view.GetRowId());
+  // fields are read in any order, char data points into the page
+  for (uint32_t i : {2, 0, 1}) {
+    ASSERT_EQ(CmpBool::kTrue, view.GetField(i).CompareEquals(fields[i]));
+  }
+  const char *page_begin = table_page.GetData();
+  const char *name = view.GetField(1).GetData();
+  ASSERT_TRUE(name > page_begin && name < page_begin + DEFAULT_PAGE_SIZE);
+  // filters are evaluated on the view
+  auto id = std::make_shared<ColumnValueExpression>(0, 0, TypeId::kTypeInt);
+  auto account = std::make_shared<ColumnValueExpression>(0, 2, TypeId::kTypeFloat);
+  auto id_eq = std::make_shared<ComparisonExpression>(
+      id, std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeInt, 188)), "=");
+  auto account_gt = std::make_shared<ComparisonExpression>(
+      account, std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeFloat, 20.0f)), ">");
+  ASSERT_EQ(CmpBool::kTrue, id_eq->Evaluate(view).CompareEquals(Field(TypeId::kTypeInt, 1)));
+  ASSERT_EQ(CmpBool::kFalse, account_gt->Evaluate(view).CompareEquals(Field(TypeId::kTypeInt, 1)));
+  ASSERT_EQ(CmpBool::kFalse, LogicExpression(id_eq, account_gt, LogicType::And)
+                                 .Evaluate(view)
+                                 .CompareEquals(Field(TypeId::kTypeInt, 1)));
+  ASSERT_EQ(CmpBool::kTrue, LogicExpression(account_gt, id_eq, LogicType::Or)
+                                .Evaluate(view)
+                                .CompareEquals(Field(TypeId::kTypeInt, 1)));
+  // rows copied out of the view own their data
+  Row copy;
+  view.ToRow(&copy);
+  ASSERT_EQ(row.GetRowId(), copy.GetRowId());
+  ASSERT_EQ(3, copy.GetFieldCount());
+  for (uint32_t i = 0; i < copy.GetFieldCount(); i++) {
+    ASSERT_EQ(CmpBool::kTrue, copy.GetField(i)->CompareEquals(fields[i]));
+  }
+  ASSERT_NE(name, copy.GetField(1)->GetData());
+  std::vector<Column *> output_columns = {new Column(columns[2]), new Column(columns[0])};
+  Schema output_schema(output_columns);
+  view.ToRow(&copy, &output_schema);
+  ASSERT_EQ(2, copy.GetFieldCount());
+  ASSERT_EQ(CmpBool::kTrue, copy.GetField(0)->CompareEquals(fields[2]));
+  ASSERT_EQ(CmpBool::kTrue, copy.GetField(1)->CompareEquals(fields[0]));
+  view.Release();
+  ASSERT_FALSE(view.IsValid());
+}
+
+TEST(TupleTest, RowIdTest) {
+  // page ids beyond 32 bits survive the packing into a single 64-bit row id
+  page_id_t page_id = (page_id_t{1} << PAGE_ID_BITS) - 1;
+  RowId rid(page_id, 65535);
+  EXPECT_EQ(page_id, rid.GetPageId());
+  EXPECT_EQ(65535, rid.GetSlotNum());
+  EXPECT_EQ(rid, RowId(rid.Get()));
+  EXPECT_EQ(INVALID_PAGE_ID, RowId().GetPageId());
+  EXPECT_EQ(INVALID_PAGE_ID, INVALID_ROWID.GetPageId());
+}
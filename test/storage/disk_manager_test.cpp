@@ -1,9 +1,49 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
 #include <unordered_set>
 
 #include "gtest/gtest.h"
 #include "glog/logging.h"
+#include "page/disk_file_meta_page.h"
+#include "storage/page_codec.h"
+
+// layout of the files created with the default page size
+static constexpr size_t BITMAP_SIZE = BitmapPage<DEFAULT_PAGE_SIZE>::GetMaxSupportedSize();
+static constexpr uint32_t EXTENTS_PER_META_PAGE = DiskFileMetaPage::GetExtentsPerMetaPage(DEFAULT_PAGE_SIZE);
+
+// whether punching a hole into file_name gives its blocks back, the file is removed afterwards
+static bool SupportsPunchHole(const std::string &file_name) {
+  bool supported = false;
+#ifdef FALLOC_FL_PUNCH_HOLE
+  int fd = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) return false;
+  std::vector<char> buf(16 * DEFAULT_PAGE_SIZE, 'x');
+  struct stat before, after;
+  if (pwrite(fd, buf.data(), buf.size(), 0) == static_cast<ssize_t>(buf.size()) && fsync(fd) == 0 &&
+      fstat(fd, &before) == 0 &&
+      fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0, 8 * DEFAULT_PAGE_SIZE) == 0 &&
+      fstat(fd, &after) == 0) {
+    supported = after.st_blocks < before.st_blocks;
+  }
+  close(fd);
+  remove(file_name.c_str());
+#endif
+  return supported;
+}
 
 TEST(DiskManagerTest, BitMapPageTest) {
   const size_t size = 512;
@@ -40,21 +80,588 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   remove(db_name.c_str());
   DiskManager *disk_mgr = new DiskManager(db_name);
   int extent_nums = 2;
-  for (uint32_t i = 0; i < DiskManager::BITMAP_SIZE * extent_nums; i++) {
+  for (uint32_t i = 0; i < BITMAP_SIZE * extent_nums; i++) {
     page_id_t page_id = disk_mgr->AllocatePage();
     DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
     EXPECT_EQ(i, page_id);
-    EXPECT_EQ(i / DiskManager::BITMAP_SIZE + 1, meta_page->GetExtentNums());
+    EXPECT_EQ(i / BITMAP_SIZE + 1, meta_page->GetExtentNums());
     EXPECT_EQ(i + 1, meta_page->GetAllocatedPages());
-    EXPECT_EQ(i % DiskManager::BITMAP_SIZE + 1, meta_page->GetExtentUsedPage(i / DiskManager::BITMAP_SIZE));
+    EXPECT_EQ(i % BITMAP_SIZE + 1, meta_page->GetExtentUsedPage(i / BITMAP_SIZE));
   }
   disk_mgr->DeAllocatePage(0);
-  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE - 1);
-  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE);
-  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE + 1);
-  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE + 2);
+  disk_mgr->DeAllocatePage(BITMAP_SIZE - 1);
+  disk_mgr->DeAllocatePage(BITMAP_SIZE);
+  disk_mgr->DeAllocatePage(BITMAP_SIZE + 1);
+  disk_mgr->DeAllocatePage(BITMAP_SIZE + 2);
   DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
-  EXPECT_EQ(extent_nums * DiskManager::BITMAP_SIZE - 5, meta_page->GetAllocatedPages());
-  EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
-  EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
-}
\ No newline at end of file
+  EXPECT_EQ(extent_nums * BITMAP_SIZE - 5, meta_page->GetAllocatedPages());
+  EXPECT_EQ(BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
+  EXPECT_EQ(BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
+}
+
+TEST(DiskManagerTest, ResidentBitmapTest) {
+  std::string db_name = "disk_bitmap_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  const page_id_t num_pages = BITMAP_SIZE + 100;
+  for (page_id_t i = 0; i < num_pages; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  // allocation only touches the bitmaps in memory
+  EXPECT_EQ(0, std::filesystem::file_size(db_name));
+  for (page_id_t i = 0; i < num_pages; i += 3) {
+    disk_mgr->DeAllocatePage(i);
+  }
+  // a data page in the middle of the first extent must not overwrite the bitmap of the second one
+  char data[DEFAULT_PAGE_SIZE];
+  memset(data, 0xff, DEFAULT_PAGE_SIZE);
+  disk_mgr->WritePage(BITMAP_SIZE / 2, data);
+  disk_mgr->FlushMetaData();
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    EXPECT_EQ(i % 3 == 0, disk_mgr->IsPageFree(i));
+  }
+  EXPECT_TRUE(disk_mgr->IsPageFree(num_pages));
+  // freed pages are handed out again lowest first
+  for (page_id_t i = 0; i < num_pages; i += 3) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  EXPECT_EQ(num_pages, disk_mgr->AllocatePage());
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AllocatePagesTest) {
+  std::string db_name = "disk_runs_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  for (page_id_t i = 0; i < 3; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  // a run starts at the next bitmap word with every page free, single pages still fill the gaps
+  EXPECT_EQ(64, disk_mgr->AllocatePages(64));
+  EXPECT_EQ(128, disk_mgr->AllocatePages(10));
+  EXPECT_EQ(3, disk_mgr->AllocatePage());
+  for (page_id_t i = 64; i < 138; i++) {
+    EXPECT_FALSE(disk_mgr->IsPageFree(i));
+  }
+  EXPECT_TRUE(disk_mgr->IsPageFree(138));
+  // a run given back can be taken again
+  for (page_id_t i = 64; i < 128; i++) {
+    disk_mgr->DeAllocatePage(i);
+  }
+  EXPECT_EQ(64, disk_mgr->AllocatePages(64));
+  // once no word of the first extent is free, runs continue in a new extent
+  page_id_t first_page_id;
+  do {
+    first_page_id = disk_mgr->AllocatePages(64);
+    ASSERT_NE(INVALID_PAGE_ID, first_page_id);
+    ASSERT_EQ(0, first_page_id % 64);
+  } while (first_page_id < static_cast<page_id_t>(BITMAP_SIZE));
+  EXPECT_EQ(BITMAP_SIZE, first_page_id);
+  EXPECT_TRUE(disk_mgr->IsPageFree(4));
+  EXPECT_EQ(4, disk_mgr->AllocatePage());
+  disk_mgr->FlushMetaData();
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name);
+  EXPECT_FALSE(disk_mgr->IsPageFree(BITMAP_SIZE + 63));
+  EXPECT_TRUE(disk_mgr->IsPageFree(BITMAP_SIZE + 64));
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, PageSizeTest) {
+  std::string db_name = "disk_page_size_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  ASSERT_EQ(0, disk_mgr->AllocatePage());
+  delete disk_mgr;
+
+  // the page size is recorded on creation
+  disk_mgr = new DiskManager(db_name);
+  auto *meta = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(DEFAULT_PAGE_SIZE, meta->GetPageSize());
+  EXPECT_EQ(DEFAULT_PAGE_SIZE, disk_mgr->GetPageSize());
+  EXPECT_FALSE(disk_mgr->IsPageFree(0));
+  delete disk_mgr;
+
+  // Scenario: a file created with an unsupported page size is refused and left untouched.
+  std::fstream file(db_name, std::ios::binary | std::ios::in | std::ios::out);
+  std::vector<char> meta_data(DEFAULT_PAGE_SIZE);
+  file.read(meta_data.data(), DEFAULT_PAGE_SIZE);
+  reinterpret_cast<DiskFileMetaPage *>(meta_data.data())->page_size_ = DEFAULT_PAGE_SIZE + 1;
+  file.seekp(0);
+  file.write(meta_data.data(), DEFAULT_PAGE_SIZE);
+  file.close();
+  EXPECT_THROW(DiskManager disk_mgr(db_name), std::runtime_error);
+  file.open(db_name, std::ios::binary | std::ios::in);
+  std::vector<char> read_back(DEFAULT_PAGE_SIZE);
+  file.read(read_back.data(), DEFAULT_PAGE_SIZE);
+  EXPECT_EQ(meta_data, read_back);
+  file.close();
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, LargePageSizeTest) {
+  std::string db_name = "disk_large_page_size_test.db";
+  const uint32_t page_size = 16384;
+  remove(db_name.c_str());
+  // Scenario: a file created with 16K pages keeps them, whatever page size it is opened with later.
+  auto *disk_mgr = new DiskManager(db_name, DEFAULT_DISK_IO_TYPE, false, false, false, page_size);
+  ASSERT_EQ(page_size, disk_mgr->GetPageSize());
+  EXPECT_EQ(BitmapPage<page_size>::GetMaxSupportedSize(), disk_mgr->GetBitmapSize());
+  const page_id_t num_pages = disk_mgr->GetBitmapSize() + 2;
+  std::vector<char> data(page_size);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+    memset(data.data(), 0, page_size);
+    snprintf(data.data(), page_size, "page %" PRId64, i);
+    data[page_size - 1] = static_cast<char>(i);
+    disk_mgr->WritePage(i, data.data());
+  }
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name);
+  ASSERT_EQ(page_size, disk_mgr->GetPageSize());
+  auto *meta = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(page_size, meta->GetPageSize());
+  EXPECT_EQ(2, meta->GetExtentNums());
+  EXPECT_EQ(static_cast<uint32_t>(num_pages), meta->GetAllocatedPages());
+  std::vector<char> expected(page_size);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    memset(expected.data(), 0, page_size);
+    snprintf(expected.data(), page_size, "page %" PRId64, i);
+    expected[page_size - 1] = static_cast<char>(i);
+    disk_mgr->ReadPage(i, data.data());
+    ASSERT_EQ(expected, data);
+  }
+  delete disk_mgr;
+
+  // the meta page, then per extent a bitmap page and its data pages, all of the page size
+  struct stat st {};
+  ASSERT_EQ(0, stat(db_name.c_str(), &st));
+  EXPECT_EQ(static_cast<off_t>(page_size) * (1 + 2 + num_pages), st.st_size);
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, PageIOTest) {
+  std::string db_name = "disk_io_test.db";
+  const page_id_t num_pages = 16;
+  struct IOMode {
+    DiskIOType io_type;
+    bool direct_io;
+  };
+  for (auto mode : {IOMode{DiskIOType::FSTREAM_IO, false}, IOMode{DiskIOType::PREAD_IO, false},
+                    IOMode{DiskIOType::PREAD_IO, true}, IOMode{DiskIOType::IO_URING, false},
+                    IOMode{DiskIOType::IO_URING, true}}) {
+    remove(db_name.c_str());
+    auto *disk_mgr = new DiskManager(db_name, mode.io_type, mode.direct_io);
+    // one byte off an aligned address, so direct I/O has to go through the bounce buffer
+    std::unique_ptr<char[]> buffer(new char[DEFAULT_PAGE_SIZE * 2]);
+    char *data = buffer.get() + 1;
+    for (page_id_t i = 0; i < num_pages; i++) {
+      memset(data, 'a' + i, DEFAULT_PAGE_SIZE);
+      disk_mgr->WritePage(i, data);
+    }
+    // reading a page that was never written returns zeros
+    memset(data, 'x', DEFAULT_PAGE_SIZE);
+    disk_mgr->ReadPage(num_pages * 4, data);
+    EXPECT_EQ(std::string(DEFAULT_PAGE_SIZE, '\0'), std::string(data, DEFAULT_PAGE_SIZE));
+    disk_mgr->Close();
+    delete disk_mgr;
+
+    disk_mgr = new DiskManager(db_name, mode.io_type, mode.direct_io);
+    for (page_id_t i = num_pages - 1; i >= 0; i--) {
+      disk_mgr->ReadPage(i, data);
+      EXPECT_EQ(std::string(DEFAULT_PAGE_SIZE, 'a' + i), std::string(data, DEFAULT_PAGE_SIZE));
+    }
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, PageCodecTest) {
+  std::mt19937 rng(7);
+  std::vector<std::string> inputs{"", "a", std::string(12, 'a'), std::string(13, 'a'), std::string(DEFAULT_PAGE_SIZE, '\0')};
+  // a lightly filled table page: a few rows of text at the end, zeroes in between
+  std::string page(DEFAULT_PAGE_SIZE, '\0');
+  for (int i = 0; i < 20; i++) {
+    std::string row = "row " + std::to_string(i) + ", name " + std::to_string(rng() % 1000) + ";";
+    page.replace(DEFAULT_PAGE_SIZE - (i + 1) * 32, row.size(), row);
+  }
+  inputs.push_back(page);
+  std::string random(DEFAULT_PAGE_SIZE, '\0');
+  for (auto &c : random) {
+    c = static_cast<char>(rng());
+  }
+  inputs.push_back(random);
+  std::vector<char> compressed(DEFAULT_PAGE_SIZE * 2);
+  for (const auto &input : inputs) {
+    size_t size = PageCodec::Compress(input.data(), input.size(), compressed.data(), compressed.size());
+    ASSERT_GT(size, 0);
+    std::string output(input.size(), 'x');
+    ASSERT_TRUE(PageCodec::Decompress(compressed.data(), size, output.data(), output.size()));
+    EXPECT_EQ(input, output);
+    // a block never decompresses to a different size, and a truncated block is rejected
+    std::string larger(input.size() + 1, 'x');
+    EXPECT_FALSE(PageCodec::Decompress(compressed.data(), size, larger.data(), larger.size()));
+    if (size > 1) {
+      EXPECT_FALSE(PageCodec::Decompress(compressed.data(), size - 1, output.data(), output.size()));
+    }
+  }
+  EXPECT_LT(PageCodec::Compress(page.data(), DEFAULT_PAGE_SIZE, compressed.data(), compressed.size()), DEFAULT_PAGE_SIZE / 4);
+  // an incompressible page does not fit a smaller buffer
+  EXPECT_EQ(0, PageCodec::Compress(random.data(), DEFAULT_PAGE_SIZE, compressed.data(), DEFAULT_PAGE_SIZE - 1));
+}
+
+TEST(DiskManagerTest, CompressedPagesTest) {
+  std::string db_name = "disk_compressed_test.db";
+  std::string store_name = CompressedPageStore::GetFileName(db_name);
+  const page_id_t num_pages = 256;
+  remove(db_name.c_str());
+  remove(store_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name, DEFAULT_DISK_IO_TYPE, false, true);
+  ASSERT_NE(nullptr, disk_mgr->GetPageStore());
+  // pages a quarter full of repeated rows
+  auto make_page = [](page_id_t page_id) {
+    std::string page(DEFAULT_PAGE_SIZE, '\0');
+    for (int offset = 0; offset < DEFAULT_PAGE_SIZE / 4; offset += 16) {
+      std::string row = "page " + std::to_string(page_id * 1000 + offset / 16);
+      page.replace(offset, row.size(), row);
+    }
+    return page;
+  };
+  for (page_id_t i = 0; i < num_pages; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+    disk_mgr->WritePage(i, make_page(i).data());
+  }
+  size_t stored_bytes = disk_mgr->GetPageStore()->GetStoredBytes();
+  EXPECT_LT(stored_bytes, num_pages * DEFAULT_PAGE_SIZE / 2);
+  std::cout << "compressed " << num_pages * DEFAULT_PAGE_SIZE << " bytes of pages to " << stored_bytes << " bytes"
+            << std::endl;
+
+  // Scenario: pages change size, move between slots and are freed.
+  std::string random(DEFAULT_PAGE_SIZE, '\0');
+  std::mt19937 rng(11);
+  for (auto &c : random) {
+    c = static_cast<char>(rng());
+  }
+  for (page_id_t i = 0; i < num_pages; i += 4) {
+    disk_mgr->WritePage(i, random.data());
+  }
+  for (page_id_t i = 1; i < num_pages; i += 4) {
+    disk_mgr->DeAllocatePage(i);
+  }
+  // a freed slot of the same size is taken by the next page that needs one
+  size_t file_size = disk_mgr->GetPageStore()->GetFileSize();
+  disk_mgr->WritePage(2, make_page(1).data());
+  EXPECT_EQ(file_size, disk_mgr->GetPageStore()->GetFileSize());
+  delete disk_mgr;
+
+  // the slots are found again from their headers, the compress flag of the file wins over the argument
+  disk_mgr = new DiskManager(db_name);
+  ASSERT_NE(nullptr, disk_mgr->GetPageStore());
+  std::vector<char> data(DEFAULT_PAGE_SIZE);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    disk_mgr->ReadPage(i, data.data());
+    std::string expected = i % 4 == 0 ? random : i % 4 == 1 ? std::string(DEFAULT_PAGE_SIZE, '\0') : make_page(i == 2 ? 1 : i);
+    ASSERT_TRUE(expected == std::string(data.data(), DEFAULT_PAGE_SIZE)) << "page " << i;
+  }
+  delete disk_mgr;
+  remove(db_name.c_str());
+  remove(store_name.c_str());
+}
+
+TEST(DiskManagerTest, VectoredIOTest) {
+  std::string db_name = "disk_vectored_test.db";
+  // a run crossing the end of the first extent is split around the bitmap of the second one
+  const page_id_t first_page_id = BITMAP_SIZE - 8;
+  const size_t count = 16;
+  for (auto io_type : {DiskIOType::FSTREAM_IO, DiskIOType::PREAD_IO}) {
+    remove(db_name.c_str());
+    auto *disk_mgr = new DiskManager(db_name, io_type);
+    std::vector<char> buf(count * DEFAULT_PAGE_SIZE);
+    for (size_t i = 0; i < count; i++) {
+      memset(buf.data() + i * DEFAULT_PAGE_SIZE, 'a' + i, DEFAULT_PAGE_SIZE);
+    }
+    disk_mgr->WritePages(first_page_id, count, buf.data());
+    char data[DEFAULT_PAGE_SIZE];
+    for (size_t i = 0; i < count; i++) {
+      disk_mgr->ReadPage(first_page_id + i, data);
+      EXPECT_EQ(std::string(DEFAULT_PAGE_SIZE, 'a' + i), std::string(data, DEFAULT_PAGE_SIZE));
+    }
+    // pages after the end of the file read as zeros
+    std::fill(buf.begin(), buf.end(), 'x');
+    disk_mgr->ReadPages(first_page_id + 4, count, buf.data());
+    for (size_t i = 0; i < count; i++) {
+      std::string expected(DEFAULT_PAGE_SIZE, i + 4 < count ? 'a' + i + 4 : '\0');
+      EXPECT_EQ(expected, std::string(buf.data() + i * DEFAULT_PAGE_SIZE, DEFAULT_PAGE_SIZE));
+    }
+    delete disk_mgr;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AsyncIOTest) {
+  std::string db_name = "disk_async_test.db";
+  const page_id_t num_pages = 64;
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name, DiskIOType::IO_URING);
+  if (disk_mgr->GetIOType() != DiskIOType::IO_URING) {
+    std::cout << "io_uring is not available, testing the pread fallback" << std::endl;
+  }
+  std::vector<std::unique_ptr<char[]>> pages;
+  std::atomic<int> completed{0};
+  for (page_id_t i = 0; i < num_pages; i++) {
+    pages.emplace_back(new char[DEFAULT_PAGE_SIZE]);
+    memset(pages[i].get(), 'A' + i % 26, DEFAULT_PAGE_SIZE);
+    disk_mgr->WritePageAsync(i, pages[i].get(), [&completed] { completed++; });
+  }
+  while (completed < num_pages) {
+    std::this_thread::yield();
+  }
+  completed = 0;
+  for (page_id_t i = 0; i < num_pages; i++) {
+    memset(pages[i].get(), 0, DEFAULT_PAGE_SIZE);
+    disk_mgr->ReadPageAsync(i, pages[i].get(), [&completed] { completed++; });
+  }
+  while (completed < num_pages) {
+    std::this_thread::yield();
+  }
+  for (page_id_t i = 0; i < num_pages; i++) {
+    EXPECT_EQ(std::string(DEFAULT_PAGE_SIZE, 'A' + i % 26), std::string(pages[i].get(), DEFAULT_PAGE_SIZE));
+  }
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, RandomReadBenchmark) {
+  std::string db_name = "disk_read_bench.db";
+  const page_id_t num_pages = 4096;
+  const int num_reads = 1 << 15;
+  const int queue_depth = 32;
+  remove(db_name.c_str());
+  {
+    DiskManager disk_mgr(db_name, DiskIOType::PREAD_IO);
+    char data[DEFAULT_PAGE_SIZE];
+    for (page_id_t i = 0; i < num_pages; i++) {
+      memset(data, i, DEFAULT_PAGE_SIZE);
+      disk_mgr.WritePage(i, data);
+    }
+  }
+  struct IOMode {
+    const char *name;
+    DiskIOType io_type;
+    bool async;
+    bool direct_io;
+  };
+  // the cached modes read from the OS page cache, the direct ones from the device
+  for (auto mode : {IOMode{"fstream", DiskIOType::FSTREAM_IO, false, false},
+                    IOMode{"pread", DiskIOType::PREAD_IO, false, false},
+                    IOMode{"io_uring", DiskIOType::IO_URING, false, false},
+                    IOMode{"io_uring async", DiskIOType::IO_URING, true, false},
+                    IOMode{"pread direct", DiskIOType::PREAD_IO, false, true},
+                    IOMode{"io_uring async direct", DiskIOType::IO_URING, true, true}}) {
+    DiskManager disk_mgr(db_name, mode.io_type, mode.direct_io);
+    if (mode.direct_io && !disk_mgr.IsDirectIO()) continue;
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+    std::vector<std::unique_ptr<char[]>> buffers;
+    for (int i = 0; i < queue_depth; i++) {
+      buffers.emplace_back(new char[DEFAULT_PAGE_SIZE]);
+    }
+    std::atomic<int> completed{0};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_reads; i++) {
+      page_id_t page_id = dist(rng);
+      if (mode.async) {
+        // keep queue_depth reads in flight, a buffer is reused once the read queue_depth earlier has completed
+        while (i - completed >= queue_depth) {
+          std::this_thread::yield();
+        }
+        disk_mgr.ReadPageAsync(page_id, buffers[i % queue_depth].get(), [&completed] { completed++; });
+      } else {
+        disk_mgr.ReadPage(page_id, buffers[0].get());
+        ASSERT_EQ(static_cast<char>(page_id), buffers[0][0]);
+      }
+    }
+    while (mode.async && completed < num_reads) {
+      std::this_thread::yield();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << mode.name << " random read: " << num_reads / elapsed << " IOPS" << std::endl;
+  }
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, TablespaceTest) {
+  std::string db_name = "disk_space_test.db";
+  std::string space_dir = DiskManager::GetSpaceDirectory(db_name);
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name, DEFAULT_DISK_IO_TYPE, false, false, true);
+  ASSERT_TRUE(disk_mgr->IsFilePerTable());
+  EXPECT_EQ(3, disk_mgr->GetTableSpace(1));
+  EXPECT_EQ(4, disk_mgr->GetIndexSpace(1));
+  EXPECT_EQ(0, disk_mgr->GetTableSpace(DiskManager::MAX_SPACES));
+  // page 0 of the db file and the first pages of two tablespaces
+  ASSERT_EQ(0, disk_mgr->AllocatePage());
+  page_id_t table_page_id = disk_mgr->AllocatePage(3);
+  ASSERT_EQ(DiskManager::MakePageId(3, 0), table_page_id);
+  page_id_t index_run = disk_mgr->AllocatePages(8, 4);
+  ASSERT_EQ(DiskManager::MakePageId(4, 0), index_run);
+  EXPECT_TRUE(std::filesystem::exists(space_dir + "/3"));
+  EXPECT_TRUE(std::filesystem::exists(space_dir + "/4"));
+  std::vector<char> buf(8 * DEFAULT_PAGE_SIZE);
+  for (size_t i = 0; i < 8; i++) {
+    memset(buf.data() + i * DEFAULT_PAGE_SIZE, 'a' + i, DEFAULT_PAGE_SIZE);
+  }
+  disk_mgr->WritePage(0, buf.data() + DEFAULT_PAGE_SIZE);
+  disk_mgr->WritePage(table_page_id, buf.data());
+  disk_mgr->WritePages(index_run, 8, buf.data());
+  delete disk_mgr;
+
+  // the tablespaces are found again when the db file is opened
+  disk_mgr = new DiskManager(db_name);
+  ASSERT_TRUE(disk_mgr->HasSpace(3));
+  ASSERT_TRUE(disk_mgr->HasSpace(4));
+  EXPECT_FALSE(disk_mgr->IsPageFree(table_page_id));
+  EXPECT_TRUE(disk_mgr->IsPageFree(DiskManager::MakePageId(3, 1)));
+  std::vector<char> data(8 * DEFAULT_PAGE_SIZE);
+  disk_mgr->ReadPage(0, data.data());
+  EXPECT_EQ(std::string(DEFAULT_PAGE_SIZE, 'b'), std::string(data.data(), DEFAULT_PAGE_SIZE));
+  disk_mgr->ReadPage(table_page_id, data.data());
+  EXPECT_EQ(std::string(DEFAULT_PAGE_SIZE, 'a'), std::string(data.data(), DEFAULT_PAGE_SIZE));
+  disk_mgr->ReadPages(index_run, 8, data.data());
+  EXPECT_TRUE(buf == data);
+
+  // dropping a tablespace removes its file, its pages read as zeros and a new one starts empty
+  disk_mgr->DropSpace(3);
+  EXPECT_FALSE(disk_mgr->HasSpace(3));
+  EXPECT_FALSE(std::filesystem::exists(space_dir + "/3"));
+  EXPECT_TRUE(disk_mgr->IsPageFree(table_page_id));
+  disk_mgr->ReadPage(table_page_id, data.data());
+  EXPECT_EQ(std::string(DEFAULT_PAGE_SIZE, '\0'), std::string(data.data(), DEFAULT_PAGE_SIZE));
+  ASSERT_EQ(table_page_id, disk_mgr->AllocatePage(3));
+  disk_mgr->ReadPage(index_run + 7, data.data());
+  EXPECT_EQ(std::string(DEFAULT_PAGE_SIZE, 'h'), std::string(data.data(), DEFAULT_PAGE_SIZE));
+  delete disk_mgr;
+
+  // a new db file of the same name does not pick up the old tablespaces
+  remove(db_name.c_str());
+  disk_mgr = new DiskManager(db_name, DEFAULT_DISK_IO_TYPE, false, false, true);
+  EXPECT_FALSE(disk_mgr->HasSpace(4));
+  EXPECT_FALSE(std::filesystem::exists(space_dir));
+  delete disk_mgr;
+  remove(db_name.c_str());
+  std::filesystem::remove_all(space_dir);
+}
+
+TEST(DiskManagerTest, SpaceReclamationTest) {
+  std::string db_name = "disk_reclaim_test.db";
+  remove(db_name.c_str());
+  if (!SupportsPunchHole(db_name)) {
+    GTEST_SKIP() << "the file system does not give the blocks of punched holes back";
+  }
+  auto *disk_mgr = new DiskManager(db_name, DiskIOType::PREAD_IO);
+  std::vector<char> buf(DEFAULT_PAGE_SIZE, 'x');
+  for (page_id_t i = 0; i < 256; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+    disk_mgr->WritePage(i, buf.data());
+  }
+  std::vector<char> data(DEFAULT_PAGE_SIZE);
+  // a page allocated again before the flush keeps its data
+  std::vector<char> other_buf(DEFAULT_PAGE_SIZE, 'y');
+  disk_mgr->DeAllocatePage(10);
+  ASSERT_EQ(10, disk_mgr->AllocatePage());
+  disk_mgr->WritePage(10, other_buf.data());
+  disk_mgr->FlushMetaData();
+  disk_mgr->ReadPage(10, data.data());
+  EXPECT_TRUE(other_buf == data);
+
+  struct stat before;
+  ASSERT_EQ(0, stat(db_name.c_str(), &before));
+  // freed pages give their disk space back and read as zeros, once their bitmap is on disk
+  disk_mgr->DeAllocatePages(64, 128);
+  disk_mgr->DeAllocatePage(200);
+  struct stat after;
+  ASSERT_EQ(0, stat(db_name.c_str(), &after));
+  EXPECT_EQ(after.st_blocks, before.st_blocks);
+  disk_mgr->FlushMetaData();
+  ASSERT_EQ(0, stat(db_name.c_str(), &after));
+  EXPECT_LT(after.st_blocks, before.st_blocks);
+  disk_mgr->ReadPage(100, data.data());
+  EXPECT_EQ(std::string(DEFAULT_PAGE_SIZE, '\0'), std::string(data.data(), DEFAULT_PAGE_SIZE));
+  disk_mgr->ReadPage(192, data.data());
+  EXPECT_TRUE(buf == data);
+  EXPECT_EQ(256, disk_mgr->GetPageEnd());
+
+  // truncating cuts the file behind the last allocated page
+  for (page_id_t i = 201; i < 256; i++) {
+    disk_mgr->DeAllocatePage(i);
+  }
+  EXPECT_EQ(200, disk_mgr->GetPageEnd());
+  disk_mgr->Truncate();
+  // the meta page, the bitmap and 200 pages
+  EXPECT_EQ(202 * DEFAULT_PAGE_SIZE, std::filesystem::file_size(db_name));
+  disk_mgr->ReadPage(199, data.data());
+  EXPECT_TRUE(buf == data);
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name, DiskIOType::PREAD_IO);
+  EXPECT_EQ(200, disk_mgr->GetPageEnd());
+  EXPECT_TRUE(disk_mgr->IsPageFree(100));
+  EXPECT_FALSE(disk_mgr->IsPageFree(199));
+  EXPECT_EQ(64, disk_mgr->AllocatePage());
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, ChainedMetaPageTest) {
+  std::string db_name = "disk_chained_meta_test.db";
+  std::string store_name = CompressedPageStore::GetFileName(db_name);
+  remove(db_name.c_str());
+  remove(store_name.c_str());
+  // a compressed file only holds the meta pages and the bitmaps, so filling its extents writes no data pages
+  auto *disk_mgr = new DiskManager(db_name, DiskIOType::PREAD_IO, false, true);
+  const page_id_t chained_page_id = static_cast<page_id_t>(EXTENTS_PER_META_PAGE) * BITMAP_SIZE;
+  for (page_id_t i = 0; i < chained_page_id; i += 64) {
+    ASSERT_EQ(i, disk_mgr->AllocatePages(64));
+  }
+  // the first page of an extent recorded by the second meta page
+  ASSERT_EQ(chained_page_id, disk_mgr->AllocatePages(64));
+  auto *meta = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(EXTENTS_PER_META_PAGE + 1, meta->GetExtentNums());
+  EXPECT_EQ(chained_page_id + 64, meta->GetAllocatedPages());
+  EXPECT_EQ(BITMAP_SIZE, meta->GetExtentUsedPage(EXTENTS_PER_META_PAGE - 1));
+  EXPECT_NE(0, meta->next_meta_page_);
+  disk_mgr->DeAllocatePage(100);
+  delete disk_mgr;
+
+  // the extents behind the chained meta page are found again
+  disk_mgr = new DiskManager(db_name, DiskIOType::PREAD_IO);
+  EXPECT_FALSE(disk_mgr->IsPageFree(chained_page_id + 63));
+  EXPECT_TRUE(disk_mgr->IsPageFree(chained_page_id + 64));
+  EXPECT_TRUE(disk_mgr->IsPageFree(100));
+  EXPECT_EQ(100, disk_mgr->AllocatePage());
+  EXPECT_EQ(chained_page_id + 64, disk_mgr->AllocatePage());
+
+  // emptying the last extent drops the chained meta page
+  disk_mgr->DeAllocatePages(chained_page_id, 65);
+  size_t file_size = std::filesystem::file_size(db_name);
+  disk_mgr->Truncate();
+  EXPECT_LT(std::filesystem::file_size(db_name), file_size);
+  meta = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(EXTENTS_PER_META_PAGE, meta->GetExtentNums());
+  EXPECT_EQ(0, meta->next_meta_page_);
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name, DiskIOType::PREAD_IO);
+  EXPECT_EQ(chained_page_id, disk_mgr->GetPageEnd());
+  EXPECT_EQ(chained_page_id, disk_mgr->AllocatePage());
+  delete disk_mgr;
+  remove(db_name.c_str());
+  remove(store_name.c_str());
+}
@@ -0,0 +1,88 @@
+#include "storage/storage_compactor.h"
+
+#include <filesystem>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+
+static string db_file_name = "storage_compactor_test.db";
+
+/**
+ * Check every row of the table through a full scan and through index lookups
+ */
+static void CheckTable(CatalogManager *catalog, int row_nums) {
+  Txn txn;
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->GetTable("table-2", table_info));
+  ASSERT_EQ(DB_SUCCESS, catalog->GetIndex("table-2", "index-2", index_info));
+  int row_count = 0;
+  for (auto it = table_info->GetTableHeap()->Begin(&txn); it != table_info->GetTableHeap()->End(); ++it) {
+    row_count++;
+  }
+  EXPECT_EQ(row_nums, row_count);
+  for (int i = 0; i < row_nums; i += 37) {
+    std::vector<RowId> result;
+    std::vector<Field> key_fields{Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn));
+    ASSERT_EQ(1, result.size());
+    Row row(result[0]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, &txn));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+  }
+}
+
+TEST(StorageCompactorTest, CompactTest) {
+  std::string db_path = "./databases/" + db_file_name;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Txn txn;
+  TableInfo *table_1 = nullptr;
+  TableInfo *table_2 = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_1));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-2", schema.get(), &txn, table_2));
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-2", "index-2", index_keys, &txn, index_info, "bptree"));
+  // the pages of the two tables interleave, so dropping the first one leaves holes all over the file
+  const int row_nums = 3000;
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+    Row row_1(fields);
+    ASSERT_TRUE(table_1->GetTableHeap()->InsertTuple(row_1, &txn));
+    Row row_2(fields);
+    ASSERT_TRUE(table_2->GetTableHeap()->InsertTuple(row_2, &txn));
+    std::vector<Field> key_fields{Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key, row_2.GetRowId(), &txn));
+  }
+  ASSERT_EQ(DB_SUCCESS, catalog_01->DropTable("table-1"));
+  db_01->bpm_->FlushAllPages();
+  size_t file_size = std::filesystem::file_size(db_path);
+  page_id_t page_end = db_01->disk_mgr_->GetPageEnd();
+
+  ASSERT_EQ(DB_SUCCESS, db_01->Compact());
+  EXPECT_LT(db_01->disk_mgr_->GetPageEnd(), page_end);
+  EXPECT_LT(std::filesystem::file_size(db_path), file_size);
+  CheckTable(catalog_01, row_nums);
+  // no free page is left below the last one
+  for (page_id_t page_id = 0; page_id < db_01->disk_mgr_->GetPageEnd(); page_id++) {
+    ASSERT_FALSE(db_01->disk_mgr_->IsPageFree(page_id));
+  }
+  delete db_01;
+
+  // the moved pages and the rewritten references are found again
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  CheckTable(db_02->catalog_mgr_, row_nums);
+  ASSERT_EQ(DB_SUCCESS, db_02->catalog_mgr_->GetTable("table-2", table_2));
+  std::vector<Field> fields{Field(TypeId::kTypeInt, row_nums),
+                            Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+  Row row(fields);
+  ASSERT_TRUE(table_2->GetTableHeap()->InsertTuple(row, &txn));
+  delete db_02;
+}
@@ -1,12 +1,21 @@
 #include "storage/table_heap.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
 #include "record/field.h"
 #include "record/schema.h"
+#include "storage/vacuum_worker.h"
 #include "utils/utils.h"
 #include "glog/logging.h"
 
@@ -63,3 +72,532 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   }
   ASSERT_EQ(size, 0);
 }
+
+TEST(TableHeapTest, InterleavedInsertTest) {
+  const std::string db_name = "table_heap_interleaved_test.db";
+  // rows of about 1K, enough for three and a half runs of pages per table
+  const int row_nums = 7 * SEGMENT_RUN_PAGES * DEFAULT_PAGE_SIZE / 2048;
+
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 900, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name(900, 'x');
+  TableHeap *table_heaps[2];
+  for (auto &table_heap : table_heaps) {
+    table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  }
+  // Scenario: two tables growing at the same time still get their pages in contiguous runs.
+  for (int i = 0; i < row_nums; i++) {
+    for (auto table_heap : table_heaps) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), 900, false)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+  }
+  for (auto table_heap : table_heaps) {
+    size_t num_pages = 0;
+    size_t num_jumps = 0;
+    for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; num_pages++) {
+      auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id));
+      ASSERT_NE(nullptr, page);
+      page_id_t next_page_id = page->GetNextPageId();
+      bpm->UnpinPage(page_id, false);
+      if (next_page_id != INVALID_PAGE_ID && next_page_id != page_id + 1) num_jumps++;
+      page_id = next_page_id;
+    }
+    EXPECT_GT(num_pages, static_cast<size_t>(SEGMENT_RUN_PAGES));
+    EXPECT_EQ((num_pages - 1) / SEGMENT_RUN_PAGES, num_jumps);
+  }
+  // the unused rest of the last runs goes back to the disk manager
+  page_id_t page_id, past_runs_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(past_runs_page_id));
+  bpm->UnpinPage(past_runs_page_id, false);
+  for (auto table_heap : table_heaps) {
+    delete table_heap;
+  }
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  EXPECT_LT(page_id, past_runs_page_id);
+  bpm->UnpinPage(page_id, false);
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  const std::string db_name = "table_heap_fsm_test.db";
+  // rows of about 1K, four to a page
+  const int row_nums = 400;
+
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, DEFAULT_PAGE_SIZE / 4 - 100, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name(DEFAULT_PAGE_SIZE / 4 - 100, 'x');
+  auto insert_row = [&](TableHeap *table_heap, int id) {
+    Fields fields{Field(TypeId::kTypeInt, id),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), false)};
+    Row row(fields);
+    EXPECT_TRUE(table_heap->InsertTuple(row, nullptr));
+    return row.GetRowId();
+  };
+  auto delete_page_rows = [&](TableHeap *table_heap, std::vector<RowId> &rids, page_id_t page_id) {
+    for (auto &rid : rids) {
+      if (rid.GetPageId() != page_id) continue;
+      ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+      table_heap->ApplyDelete(rid, nullptr);
+    }
+  };
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    rids.push_back(insert_row(table_heap, i));
+  }
+  page_id_t last_page_id = rids.back().GetPageId();
+  // Scenario: the space freed in a page in the middle of the heap is found again by the next insert.
+  page_id_t hole_page_id = rids[row_nums / 3].GetPageId();
+  delete_page_rows(table_heap, rids, hole_page_id);
+  EXPECT_EQ(hole_page_id, insert_row(table_heap, row_nums).GetPageId());
+  delete table_heap;
+
+  // Scenario: the free space map is kept on disk, a reopened heap finds the holes and its last page.
+  table_heap = TableHeap::Create(bpm, first_page_id, schema.get(), nullptr, nullptr);
+  page_id_t other_hole_page_id = rids[row_nums / 2].GetPageId();
+  delete_page_rows(table_heap, rids, other_hole_page_id);
+  for (int i = 1; i < 4; i++) {
+    EXPECT_EQ(hole_page_id, insert_row(table_heap, row_nums + i).GetPageId());
+  }
+  for (int i = 4; i < 8; i++) {
+    EXPECT_EQ(other_hole_page_id, insert_row(table_heap, row_nums + i).GetPageId());
+  }
+  // the heap is full, a new page is appended behind the last one
+  page_id_t new_page_id = insert_row(table_heap, row_nums + 8).GetPageId();
+  auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(last_page_id));
+  EXPECT_EQ(new_page_id, page->GetNextPageId());
+  bpm->UnpinPage(last_page_id, false);
+  int rows = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); it++) {
+    rows++;
+  }
+  EXPECT_EQ(row_nums + 1, rows);
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, InsertBenchmark) {
+  const std::string db_name = "table_heap_insert_bench.db";
+  const int row_nums = 40000;
+
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 200, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name(200, 'x');
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  // Scenario: inserting into a growing heap does not slow down with the number of its pages.
+  for (int round = 0; round < 4; round++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < row_nums / 4; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), 200, false)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "insert rows " << round * row_nums / 4 << " to " << (round + 1) * row_nums / 4 << ": "
+              << elapsed / (row_nums / 4) << " ns/row" << std::endl;
+  }
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, BulkInsertTest) {
+  const std::string db_name = "table_heap_bulk_insert_test.db";
+  const int row_nums = 3000;
+
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name(64, 'x');
+  auto make_row = [&](int id) {
+    Fields fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), 64, false)};
+    return Row(fields);
+  };
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  Row first_row = make_row(0);
+  ASSERT_TRUE(table_heap->InsertTuple(first_row, nullptr));
+  std::vector<Row> rows;
+  for (int i = 1; i < row_nums; i++) {
+    rows.push_back(make_row(i));
+  }
+  ASSERT_TRUE(table_heap->BulkInsert(rows, nullptr));
+  // Scenario: the rows are appended in order and can be read through their row ids.
+  for (int i = 1; i < row_nums; i += 97) {
+    Row row(rows[i - 1].GetRowId());
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+  }
+  // the next insert goes to the space left in the last page, or to a page appended behind it
+  Row last_row = make_row(row_nums);
+  ASSERT_TRUE(table_heap->InsertTuple(last_row, nullptr));
+  page_id_t last_page_id = rows.back().GetRowId().GetPageId();
+  if (last_row.GetRowId().GetPageId() != last_page_id) {
+    auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(last_page_id));
+    EXPECT_EQ(last_row.GetRowId().GetPageId(), page->GetNextPageId());
+    bpm->UnpinPage(last_page_id, false);
+  }
+  int rows_read = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); it++) {
+    ASSERT_EQ(CmpBool::kTrue, it->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, rows_read)));
+    rows_read++;
+  }
+  EXPECT_EQ(row_nums + 1, rows_read);
+  // a row too large for any page stops the load
+  std::vector<Column *> wide_columns = {new Column("name", TypeId::kTypeChar, DEFAULT_PAGE_SIZE, 0, false, false)};
+  auto wide_schema = std::make_shared<Schema>(wide_columns);
+  TableHeap *wide_heap = TableHeap::Create(bpm, wide_schema.get(), nullptr, nullptr, nullptr);
+  std::string wide_name(DEFAULT_PAGE_SIZE, 'x');
+  Fields wide_fields{Field(TypeId::kTypeChar, const_cast<char *>(wide_name.c_str()), DEFAULT_PAGE_SIZE, false)};
+  std::vector<Row> wide_rows{Row(wide_fields)};
+  EXPECT_FALSE(wide_heap->BulkInsert(wide_rows, nullptr));
+  delete wide_heap;
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+/**
+ * @return the number of pages in the chain of a heap, checking the prev page ids against the next page ids
+ */
+static int CountChainPages(BufferPoolManager *bpm, page_id_t first_page_id) {
+  int pages = 0;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID; pages++) {
+    auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id));
+    EXPECT_EQ(prev_page_id, page->GetPrevPageId());
+    prev_page_id = page_id;
+    page_id = page->GetNextPageId();
+    bpm->UnpinPage(prev_page_id, false);
+  }
+  return pages;
+}
+
+TEST(TableHeapTest, VacuumTest) {
+  const std::string db_name = "table_heap_vacuum_test.db";
+  const int row_nums = 2000;
+
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 200, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name(200, 'x');
+  auto insert_row = [&](TableHeap *table_heap, int id) {
+    Fields fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), 200, false)};
+    Row row(fields);
+    EXPECT_TRUE(table_heap->InsertTuple(row, nullptr));
+    return row.GetRowId();
+  };
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  std::unordered_map<int, RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    rids[i] = insert_row(table_heap, i);
+  }
+  int pages = CountChainPages(bpm, first_page_id);
+  // Scenario: nine in ten rows are deleted, the heap shrinks to about a tenth and the moved rows are reported.
+  for (int i = 0; i < row_nums; i++) {
+    if (i % 10 != 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+      rids.erase(i);
+    }
+  }
+  int moves = 0;
+  auto on_move = [&](Row &row, const RowId &old_rid) {
+    int id = std::stoi(row.GetField(0)->toString());
+    EXPECT_EQ(rids[id], old_rid);
+    rids[id] = row.GetRowId();
+    moves++;
+  };
+  EXPECT_EQ(pages, table_heap->Vacuum(pages, on_move));
+  EXPECT_EQ(0, table_heap->Vacuum(pages, on_move));
+  EXPECT_GT(moves, 0);
+  int vacuumed_pages = CountChainPages(bpm, first_page_id);
+  EXPECT_LE(vacuumed_pages * 4, pages);
+  int rows_read = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); it++) {
+    int id = std::stoi(it->GetField(0)->toString());
+    ASSERT_EQ(0, id % 10);
+    EXPECT_EQ(rids[id], it->GetRowId());
+    rows_read++;
+  }
+  EXPECT_EQ(row_nums / 10, rows_read);
+  // the free space map knows the merged pages are gone and the compacted pages have room
+  for (int i = 0; i < row_nums / 100; i++) {
+    insert_row(table_heap, row_nums + i);
+  }
+  EXPECT_EQ(vacuumed_pages, CountChainPages(bpm, first_page_id));
+  delete table_heap;
+
+  // Scenario: a reopened heap does not know where its deletes are, every page is visited once.
+  table_heap = TableHeap::Create(bpm, first_page_id, schema.get(), nullptr, nullptr);
+  EXPECT_EQ(vacuumed_pages, table_heap->Vacuum(pages, on_move));
+  EXPECT_EQ(0, table_heap->Vacuum(pages, on_move));
+  insert_row(table_heap, 2 * row_nums);
+  rows_read = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); it++) {
+    rows_read++;
+  }
+  EXPECT_EQ(row_nums / 10 + row_nums / 100 + 1, rows_read);
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, VacuumWorkerTest) {
+  const std::string db_name = "table_heap_vacuum_worker_test.db";
+  const int row_nums = 2000;
+
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 200, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name(200, 'x');
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), 200, false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  int pages = CountChainPages(bpm, table_heap->GetFirstPageId());
+  const size_t pages_per_round = 4;
+  auto worker = new VacuumWorker(
+      [&](std::vector<VacuumWorker::Table> &tables) { tables.push_back({table_heap, nullptr}); }, pages_per_round, 1);
+  {
+    // Scenario: the worker stays out while foreground work runs.
+    auto foreground = worker->Foreground();
+    for (auto &rid : rids) {
+      ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(0, worker->GetVisitedPages());
+  }
+  // Scenario: a round visits a bounded number of pages, and the worker gets through all of them in the background.
+  EXPECT_LE(worker->RunRound(), pages_per_round);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (worker->GetVisitedPages() < static_cast<size_t>(pages) && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  size_t visited_pages = worker->GetVisitedPages();
+  delete worker;
+  EXPECT_EQ(pages, visited_pages);
+  EXPECT_EQ(1, CountChainPages(bpm, table_heap->GetFirstPageId()));
+  EXPECT_TRUE(table_heap->Begin(nullptr) == table_heap->End());
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, VacuumScanBenchmark) {
+  const std::string db_name = "table_heap_vacuum_bench.db";
+  const int row_nums = 20000;
+  const size_t buffer_pool_size = 256;
+
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 200, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name(200, 'x');
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), 200, false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // every other row is deleted, leaving every page half empty
+  for (int i = 1; i < row_nums; i += 2) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+  }
+  auto cold_scan = [&](const char *label) {
+    int fd = open(db_name.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    bpm = new BufferPoolManager(buffer_pool_size, disk_mgr);
+    table_heap = TableHeap::Create(bpm, first_page_id, schema.get(), nullptr, nullptr);
+    auto start = std::chrono::steady_clock::now();
+    int rows = 0;
+    for (auto it = table_heap->Begin(nullptr, true); it != table_heap->End(); it++) {
+      rows++;
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(row_nums / 2, rows);
+    std::cout << label << ": " << CountChainPages(bpm, first_page_id) << " pages, cold scan " << elapsed << " ms"
+              << std::endl;
+  };
+  delete table_heap;
+  delete bpm;
+
+  // Scenario: a cold full scan of the heap before and after it is vacuumed.
+  cold_scan("before vacuum");
+  int pages = CountChainPages(bpm, first_page_id);
+  while (table_heap->Vacuum(VACUUM_PAGES_PER_ROUND, [](Row &, const RowId &) {}) > 0) {
+  }
+  int vacuumed_pages = CountChainPages(bpm, first_page_id);
+  EXPECT_LT(vacuumed_pages * 3, pages * 2);
+  delete table_heap;
+  delete bpm;
+  cold_scan("after vacuum");
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, TupleViewScanBenchmark) {
+  const std::string db_name = "table_heap_tuple_view_bench.db";
+  const int row_nums = 20000;
+  const int selected = row_nums / 100;
+
+  remove(db_name.c_str());
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 200, 1, false, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name(200, 'x');
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), 200, false),
+                  Field(TypeId::kTypeFloat, static_cast<float>(i))};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  // where account < selected, on the last column so every field before it is walked
+  auto predicate = std::make_shared<ComparisonExpression>(
+      std::make_shared<ColumnValueExpression>(0, 2, TypeId::kTypeFloat),
+      std::make_shared<ConstantValueExpression>(Field(TypeId::kTypeFloat, static_cast<float>(selected))), "<");
+  auto passes = [](const Field &result) { return result.CompareEquals(Field(TypeId::kTypeInt, 1)) == CmpBool::kTrue; };
+
+  // Scenario: a filtered scan over a warm buffer pool, with the predicate on materialized rows and on views.
+  for (bool use_view : {false, true}) {
+    auto start = std::chrono::steady_clock::now();
+    int rows = 0;
+    for (int round = 0; round < 5; round++) {
+      TupleView view;
+      for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+        if (use_view) {
+          ASSERT_TRUE(it.GetView(&view));
+          if (passes(predicate->Evaluate(view))) {
+            Row row;
+            view.ToRow(&row);
+            rows++;
+          }
+        } else if (passes(predicate->Evaluate(&*it))) {
+          rows++;
+        }
+      }
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(selected * 5, rows);
+    std::cout << (use_view ? "tuple view" : "materialized row") << " filtered scan: " << elapsed / 5 << " ms"
+              << std::endl;
+  }
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, LargePageSizeTest) {
+  const std::string db_name = "table_heap_large_page_size_test.db";
+  const uint32_t page_size = 16384;
+  const int row_nums = 20;
+  const int name_columns = 4;
+  const uint32_t name_len = 1800;
+
+  remove(db_name.c_str());
+  // a row of more than 7000 bytes, made of several columns as a varchar is at most VARCHAR_MAX_LEN long
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  for (int i = 1; i <= name_columns; i++) {
+    columns.push_back(new Column("name" + std::to_string(i), TypeId::kTypeChar, name_len, i, false, false));
+  }
+  auto schema = std::make_shared<Schema>(columns);
+  std::string name(name_len, 'x');
+  auto make_row = [&](int id) {
+    Fields fields{Field(TypeId::kTypeInt, id)};
+    for (int i = 1; i <= name_columns; i++) {
+      fields.emplace_back(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name_len, false);
+    }
+    return Row(fields);
+  };
+  // Scenario: a row too large for a page of the default size is refused there.
+  auto disk_mgr = new DiskManager(db_name);
+  auto bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  TableHeap *table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  Row refused_row = make_row(0);
+  EXPECT_FALSE(table_heap->InsertTuple(refused_row, nullptr));
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+
+  // Scenario: a database created with 16K pages holds two of those rows per page, also after it is reopened.
+  disk_mgr = new DiskManager(db_name, DEFAULT_DISK_IO_TYPE, false, false, false, page_size);
+  bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  ASSERT_EQ(page_size, bpm->GetPageSize());
+  table_heap = TableHeap::Create(bpm, schema.get(), nullptr, nullptr, nullptr);
+  for (int i = 0; i < row_nums; i++) {
+    Row row = make_row(i);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  EXPECT_EQ(row_nums / 2, CountChainPages(bpm, first_page_id));
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+
+  disk_mgr = new DiskManager(db_name);
+  bpm = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr);
+  ASSERT_EQ(page_size, bpm->GetPageSize());
+  table_heap = TableHeap::Create(bpm, first_page_id, schema.get(), nullptr, nullptr);
+  int rows_read = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); it++) {
+    ASSERT_EQ(CmpBool::kTrue, it->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, rows_read)));
+    ASSERT_EQ(name_len, it->GetField(name_columns)->GetLength());
+    rows_read++;
+  }
+  EXPECT_EQ(row_nums, rows_read);
+  delete table_heap;
+  delete bpm;
+  delete disk_mgr;
+  remove(db_name.c_str());
+}